@@ -96,6 +96,7 @@
 #include <unordered_map>
 #include <vector>
 #include <boost/format.hpp>
+#include <boost/optional.hpp>
 
 //! \endcond
 
@@ -383,6 +383,10 @@ public:
 	operator sMultiParm& ();
 	operator const sMultiParm& () const;
 
+	// Views an engine-owned sMultiParm in place; the layouts are identical.
+	static LGMultiBase& view (sMultiParm&);
+	static const LGMultiBase& view (const sMultiParm&);
+
 	LGMultiBase& operator = (const sMultiParm&);
 	void clear ();
 
@@ -490,6 +494,42 @@ public:
 
 
 
+// LGMultiLocal: wrapper holding short strings and vectors without allocation
+
+/* Only for values passed to the engine as const sMultiParm&, which the engine
+ * copies. The engine must never write to, free, or keep an LGMultiLocal. */
+template <typename T>
+class LGMultiLocal : public LGMulti<T>
+{
+public:
+	LGMultiLocal (const T& value) : LGMulti<T> (value) {}
+};
+
+template<>
+class LGMultiLocal<String> : public LGMultiBase
+{
+public:
+	LGMultiLocal (const String& value);
+	~LGMultiLocal ();
+
+private:
+	enum { INLINE_SIZE = 32 };
+	char buffer [INLINE_SIZE];
+};
+
+template<>
+class LGMultiLocal<Vector> : public LGMultiBase
+{
+public:
+	LGMultiLocal (const Vector& value);
+	~LGMultiLocal ();
+
+private:
+	Vector buffer;
+};
+
+
+
 // FieldProxyConfig: common configuration for PropField and LinkField proxies
 
 template <typename Type>
@@ -537,8 +577,10 @@ inline Type
 FieldProxyConfig<Type>::default_getter (const Item& item,
 	const LGMultiBase& multi)
 {
+	static_assert (sizeof (LGMulti<StorageType>) == sizeof (LGMultiBase),
+		"LGMulti subclasses must not add members");
 	return multi.empty () ? item.default_value : Type (StorageType
-		(reinterpret_cast<const LGMulti<StorageType>&> (multi)));
+		(static_cast<const LGMulti<StorageType>&> (multi)));
 }
 
 template <typename Type> template <typename StorageType>
@@ -546,7 +588,9 @@ inline void
 FieldProxyConfig<Type>::default_setter (const Item&, LGMultiBase& multi,
 	const Type& value)
 {
-	reinterpret_cast<LGMulti<StorageType>&> (multi) = StorageType (value);
+	static_assert (sizeof (LGMulti<StorageType>) == sizeof (LGMultiBase),
+		"LGMulti subclasses must not add members");
+	static_cast<LGMulti<StorageType>&> (multi) = StorageType (value);
 }
 
 
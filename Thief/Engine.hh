@@ -51,6 +51,13 @@ public:
 	 * automatically. This method should not usually be called by others. */
 	void attach (MPrintfProc proc);
 
+	/*! Copies all data sent to the logging stream to the given file.
+	 * Lines are appended to the file in addition to being sent to the
+	 * monolog, if any, so this also works in the main game executable.
+	 * An empty path closes any file previously attached.
+	 * \return Whether a file is now attached. */
+	bool attach_file (const String& path);
+
 	/*! Sends the given string directly to the log, bypassing the buffer.
 	 * A newline will be added at the end of the string, whether or not one
 	 * is already present. While the given line will not be interrupted,
@@ -64,9 +71,18 @@ public:
 	 * progress. */
 	void log (const boost::format&);
 
+	//! \cond HIDDEN_SYMBOLS
+	/* Sets a function to be called before log() sends a line, so that
+	 * output held back elsewhere in this module can be sent first. */
+	typedef void (*Hook) ();
+	static void set_log_hook (Hook);
+	//! \endcond
+
 private:
 	class Streambuf;
 	std::unique_ptr<Streambuf> buf;
+
+	static Hook log_hook;
 };
 
 /*! A logging stream that outputs to the monolog in DromEd.
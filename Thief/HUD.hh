@@ -139,9 +139,57 @@ struct CanvasRect : public CanvasPoint, public CanvasSize
 
 
 
+/*! A snapshot of the view for the current HUD frame.
+ * The central HUD handler captures the canvas and camera state once at the
+ * start of each frame. Per-frame geometry calculations, such as the onscreen()
+ * checks of CanvasPoint and CanvasRect, read this snapshot rather than asking
+ * the engine each time. Outside of a frame, only the canvas size is refreshed
+ * when the snapshot is requested; the camera is that of the last frame drawn. */
+struct HUDFrameContext
+{
+	/*! The sequence number of the frame.
+	 * Frames are counted from one; zero means no frame has been drawn. */
+	unsigned long number;
+
+	//! The size of the canvas (screen).
+	CanvasSize canvas_size;
+
+	//! The aspect ratio of the canvas.
+	float aspect_ratio;
+
+	/*! The horizontal field of view for a 4:3 canvas, in degrees.
+	 * This is the \c fov config variable, and does not reflect zooming. */
+	float field_of_view;
+
+	/*! Whether the camera location and rotation are known.
+	 * They are only available in NewDark 1.22 or later. */
+	bool camera_known;
+
+	//! The location of the camera in the world.
+	Vector camera_location;
+
+	//! The rotation of the camera in the world.
+	Vector camera_rotation;
+
+	//! Constructs an empty snapshot.
+	HUDFrameContext ();
+
+	/*! Returns the snapshot for the frame being drawn.
+	 * If no frame is being drawn, the snapshot of the most recent frame is
+	 * returned with its canvas size refreshed. Before any frame, the
+	 * canvas and camera state are captured from the engine. */
+	static const HUDFrameContext& get ();
+};
+
+
+
 /*! A bitmap image loaded into memory to be drawn on the HUD.
+ * Recently used bitmaps are kept loaded for a while after their last handle is
+ * released, including between sims, so that loading them again is immediate.
+ * When a sim starts, any frames that the engine discarded are loaded again.
  * \note A maximum of 128 HUD bitmap frames can be loaded at any time (counting
- * frames of an animation individually). */
+ * frames of an animation individually). This includes the frames kept by the
+ * cache of recently used bitmaps; see set_cache_limit(). */
 class HUDBitmap
 {
 public:
@@ -160,9 +208,60 @@ public:
 	 * frames as are available, following the engine's standard scheme for
 	 * naming animation frames. If \a animation is \c false, the method will
 	 * only attempt to load the exact \a path given. \return A handle to the
-	 * loaded bitmap, or an empty handle if an error occurred. */
+	 * loaded bitmap, or an empty handle if an error occurred.
+	 *
+	 * The frames of an animation may be listed in a manifest file with the
+	 * same path as the bitmap but the extension \c .frames instead. Each
+	 * non-empty line of the manifest names one frame file, in order, in
+	 * the bitmap's directory. Without a manifest, frames stored as loose
+	 * files are found by listing their directory; otherwise, each frame is
+	 * tried in turn until one is missing. */
 	static Ptr load (const String& path, bool animation);
 
+	/*! Loads the given bitmap images ahead of their first use.
+	 * Each bitmap is loaded as by load() and kept in memory until the end
+	 * of the sim, even if no handle to it is held, so that a later load()
+	 * of the same path returns immediately. A script may call this method
+	 * when the sim starts to avoid loading bitmaps while drawing.
+	 * \return The number of bitmaps that were loaded successfully. */
+	static size_t preload (const std::vector<String>& paths,
+		bool animation);
+
+	//! Statistics for the cache of recently used HUD bitmaps.
+	struct CacheStats
+	{
+		//! The number of loads answered by an already loaded bitmap.
+		unsigned long hits;
+
+		//! The number of loads that had to read the bitmap.
+		unsigned long misses;
+
+		//! The number of bitmaps dropped to stay within the limit.
+		unsigned long evictions;
+
+		//! The number of bitmaps currently kept by the cache.
+		size_t bitmaps;
+
+		//! The number of frames currently kept by the cache.
+		Frame frames;
+
+		//! The most frames that the cache will keep.
+		Frame limit;
+	};
+
+	/*! Returns statistics for the cache of recently used bitmaps.
+	 * The cache is shared by all script modules. */
+	static CacheStats get_cache_stats ();
+
+	/*! Sets the most frames that the cache of recently used bitmaps will
+	 * keep loaded. Bitmaps are dropped in order of least recent loading or
+	 * drawing until the cache is within the limit. If the engine cannot
+	 * load a bitmap, bitmaps kept only by the cache are dropped and the
+	 * load is tried again. A bitmap still in use stays loaded,
+	 * but no longer counts toward the limit. The default is 64 frames. A
+	 * limit of zero disables the cache. */
+	static void set_cache_limit (Frame frames);
+
 	//! Destroys a HUD bitmap handle and unloads the bitmap from memory.
 	virtual ~HUDBitmap ();
 
@@ -186,14 +285,153 @@ private:
 	friend class OSL;
 	HUDBitmap (const String& path, bool animation);
 
+	// Loads again any frames whose handles the engine discarded. Returns
+	// whether any frames remain.
+	bool revalidate ();
+
 	const String path;
+	String directory;
 
 	typedef int Handle;
 	std::vector<Handle> frames;
+	std::vector<String> frame_files; // in directory, to load them again
+	CanvasSize size; // of the first frame
+
+	// The number of the HUD frame in which the bitmap was last loaded or
+	// drawn, for the cache's order of eviction.
+	mutable unsigned long last_used;
+};
+
+
+
+/*! A set of sprites (images) drawn from portions of a single HUD bitmap.
+ * A sprite sheet divides a bitmap into regions that can be drawn individually,
+ * such as the icons of an inventory grid. Drawing many sprites from one sheet
+ * with HUDElement::draw_sprites() takes fewer engine calls than drawing them
+ * as separate bitmaps. */
+class HUDSpriteSheet
+{
+public:
+	//! The index of a sprite within a sheet.
+	typedef size_t Sprite;
+
+	//! A sprite to be drawn at a given position by draw_sprites().
+	struct Placement
+	{
+		//! The sprite to be drawn.
+		Sprite sprite;
+
+		//! The top left corner of the sprite, relative to the element.
+		CanvasPoint position;
+	};
+
+	/*! Constructs a sprite sheet with no sprites.
+	 * Sprites can be added with add_sprite(). \throw MissingResource if
+	 * the bitmap handle is empty. */
+	explicit HUDSpriteSheet (const HUDBitmap::Ptr& bitmap);
+
+	/*! Constructs a sprite sheet from a grid of equally sized cells.
+	 * The sprites are numbered from left to right, then from top to
+	 * bottom. Any partial cells at the right or bottom edges are ignored.
+	 * \throw MissingResource if the bitmap handle is empty.
+	 * \throw std::invalid_argument if the cell size is not positive. */
+	HUDSpriteSheet (const HUDBitmap::Ptr& bitmap, CanvasSize cell_size);
+
+	//! Returns the bitmap from which the sprites are drawn.
+	const HUDBitmap::Ptr& get_bitmap () const { return bitmap; }
+
+	//! Returns the number of sprites in the sheet.
+	Sprite count_sprites () const { return sprites.size (); }
+
+	/*! Returns the portion of the bitmap covered by the given sprite.
+	 * \throw std::out_of_range if the sprite is not in the sheet. */
+	const CanvasRect& get_sprite (Sprite sprite) const
+		{ return sprites.at (sprite); }
+
+	/*! Adds a sprite covering the given portion of the bitmap.
+	 * \return The index of the new sprite. */
+	Sprite add_sprite (const CanvasRect& area);
+
+private:
+	HUDBitmap::Ptr bitmap;
+	std::vector<CanvasRect> sprites;
 };
 
 
 
+/*! A block of text broken into lines and aligned for drawing on the HUD.
+ * A text layout wraps its text at spaces so that no line is wider than a given
+ * width, and aligns each line horizontally within the block. The line breaks
+ * are calculated the first time the layout is measured or drawn, then reused
+ * until the layout is changed or the user returns to game mode. A layout is
+ * drawn and measured by passing it to HUDElement::draw_text() and
+ * HUDElement::get_text_size() in place of a string. */
+class TextLayout
+{
+public:
+	//! The horizontal alignment of the lines in a text layout.
+	enum class Alignment
+	{
+		LEFT,   //!< Each line starts at the left edge of the block.
+		CENTER, //!< Each line is centered within the block.
+		RIGHT   //!< Each line ends at the right edge of the block.
+	};
+
+	/*! Constructs a text layout. \param text The text to be laid out.
+	 * Line breaks in the string will be preserved. \param width The
+	 * maximum width of a line in pixels, or zero to break lines only where
+	 * the text does. If non-zero, the block will be this wide; otherwise,
+	 * it will be as wide as its widest line. \param alignment The
+	 * alignment of the lines within the block. */
+	explicit TextLayout (const String& text = String (), int width = 0,
+		Alignment alignment = Alignment::LEFT);
+
+	//! Returns the text to be laid out.
+	const String& get_text () const { return text; }
+
+	//! Sets the text to be laid out.
+	void set_text (const String&);
+
+	//! Returns the maximum width of a line, or zero if unlimited.
+	int get_width () const { return width; }
+
+	//! Sets the maximum width of a line, or zero if unlimited.
+	void set_width (int);
+
+	//! Returns the alignment of the lines within the block.
+	Alignment get_alignment () const { return alignment; }
+
+	//! Sets the alignment of the lines within the block.
+	void set_alignment (Alignment);
+
+private:
+	friend class HUDElement;
+
+	String text;
+	int width;
+	Alignment alignment;
+
+	struct Line
+	{
+		String text;
+		CanvasPoint position; // relative to the block
+		int width;
+	};
+
+	mutable std::vector<Line> lines;
+	mutable CanvasSize size;
+	mutable bool laid_out;
+	mutable unsigned long generation; // of the text measurements used
+
+	void update () const;
+	void add_line (const String& text, CanvasSize text_size,
+		int blank_height) const;
+};
+
+
+
+struct HUDElementStats;
+
 /*! A minimal interface for creating HUD elements.
  * This class handles registration of a HUD element with the central HUD handler.
  * HUDElement provides the full set of methods needed to draw an element. */
@@ -213,14 +451,32 @@ public:
 		DRAW_STAGE_1,    /*!< Draw a non-overlay element in this frame.
 		                  * Overlay elements may do preparatory work
 		                  * at this stage. */
-		DRAW_STAGE_2     //!< Draw an overlay element in this frame.
+		DRAW_STAGE_2,    //!< Draw an overlay element in this frame.
+		REPLAY_STAGE_1,  /*!< Draw a non-overlay element in this frame
+		                  * by repeating its previous drawing if it
+		                  * can, or as for #DRAW_STAGE_1 if it cannot.
+		                  * Only sent to elements that have set a
+		                  * frame budget (see set_frame_budget()). */
+		REPLAY_STAGE_2   /*!< Draw an overlay element in this frame
+		                  * with its existing contents, leaving any
+		                  * pending update for its next full drawing.
+		                  * Sent in the same frames as
+		                  * #REPLAY_STAGE_1. */
 	};
 
+	/*! Returns drawing statistics for all registered HUD elements.
+	 * The statistics are shared by all script modules. The returned list
+	 * remains valid until the next call to this method. */
+	static const std::vector<HUDElementStats>& get_stats ();
+
 protected:
 	/*! Registers the element with the central HUD handler.
-	 * No check is performed for a redundant call. \param priority The
-	 * Z-index of the element relative to others. \throw std::runtime_error
-	 * if the registration fails. */
+	 * A redundant call only changes the element's priority. Registration
+	 * changes made while the elements are being drawn or notified,
+	 * including those by initialize(), deinitialize(), and set_priority(),
+	 * take effect once all of them have been.
+	 * \param priority The Z-index of the element relative to others.
+	 * \throw std::runtime_error if the registration fails. */
 	void initialize (ZIndex priority);
 
 	/*! Deregisters the element with the central HUD handler.
@@ -228,6 +484,21 @@ protected:
 	 * element had been registered. */
 	bool deinitialize ();
 
+	/*! Changes the stacking priority of the element.
+	 * Elements of the same priority are stacked in the order in which they
+	 * were registered.
+	 * \return Whether the element was registered. */
+	bool set_priority (ZIndex priority);
+
+	/*! Sets the time that the element's drawing should take in a frame.
+	 * If the element's average drawing time in both stages exceeds
+	 * \a budget, in microseconds, the central HUD handler will send it
+	 * #DRAW_STAGE_1 and #DRAW_STAGE_2 events only every few frames and
+	 * #REPLAY_STAGE_1 and #REPLAY_STAGE_2 events in between.
+	 * A budget of zero, the default, disables this throttling. The element
+	 * must be registered. \return Whether the element was registered. */
+	bool set_frame_budget (unsigned long budget);
+
 	/*! Handles a HUD event.
 	 * A derived class must implement this method to handle HUD events. */
 	virtual void on_event (Event event) = 0;
@@ -238,6 +509,37 @@ private:
 
 
 
+//! Drawing statistics for a HUD element, as kept by the central HUD handler.
+struct HUDElementStats
+{
+	//! The class name of the element.
+	String type;
+
+	//! The stacking priority of the element.
+	HUDElementBase::ZIndex priority;
+
+	//! The number of frames in which the element was drawn in full.
+	unsigned long draws;
+
+	//! The number of frames in which the element's drawing was replayed.
+	unsigned long replays;
+
+	/*! The recent average time of a full drawing, in microseconds.
+	 * This includes the time taken in both stages of the frame. */
+	unsigned long mean_time;
+
+	//! The longest time of a full drawing, in microseconds.
+	unsigned long worst_time;
+
+	//! The element's frame budget in microseconds, or zero if none.
+	unsigned long budget;
+
+	//! The element is currently drawn in full once in this many frames.
+	unsigned interval;
+};
+
+
+
 /*! A head-up display (HUD) element drawn above the world.
  * A head-up display element is an interface element drawn on screen above the
  * rendered 3D world. In the standard Thief interface, the HUD elements are the
@@ -252,12 +554,15 @@ private:
  * any needed calculations or resource allocations.
  *
  * Currently, all HUD elements are of non-overlay type. These are redrawn to the
- * canvas (screen) in their entirety for every frame. The other type of element,
- * the overlay element, is not yet supported by ThiefLib due to unresolved bugs.
- * Overlay elements are redrawn only when they have changed; the engine copies
- * their buffers to the screen in each frame. As such, they also support smooth
- * scaling and variable opacity. There is a limit of 64 overlay elements at any
- * time.
+ * canvas (screen) in their entirety for every frame. A retained element (see
+ * set_retained()) records its drawing the first time and replays it in later
+ * frames without calling redraw() until it schedules a redraw or is moved.
+ *
+ * The other type of element, the overlay element, is not yet supported by
+ * ThiefLib due to unresolved bugs. Overlay elements are redrawn only when they
+ * have changed; the engine copies their buffers to the screen in each frame. As
+ * such, they also support smooth scaling and variable opacity. There is a limit
+ * of 64 overlay elements at any time.
  *
  * The Dark %Engine expects a central handler to do all HUD drawing. ThiefLib
  * provides such a handler, and it supports a theoretically unlimited number of
@@ -293,8 +598,9 @@ protected:
 
 	/*! Schedules the element to be redrawn in the next frame.
 	 * This method should be called whenever the drawn content of the
-	 * element needs to change. Non-overlay elements are already drawn
-	 * in every frame, so this method is informational only for them. */
+	 * element needs to change. Non-overlay elements that are not retained
+	 * are already drawn in every frame, so this method is informational
+	 * only for them. */
 	void schedule_redraw ();
 
 	//@}
@@ -332,6 +638,29 @@ protected:
 	void set_scale (float);
 #endif
 
+	//! Returns whether the element's drawing is retained between frames.
+	bool is_retained () const { return retained; }
+
+	/*! Sets whether the element's drawing is retained between frames.
+	 * A retained non-overlay element records the drawing done by redraw()
+	 * and replays it in each frame until schedule_redraw() is called or
+	 * the element's position or size changes. An element whose content
+	 * changes from frame to frame, such as one following an object on
+	 * screen, must schedule a redraw whenever it does so. Elements are not
+	 * retained by default. */
+	void set_retained (bool retained);
+
+	//! Returns the element's frame budget in microseconds, or zero if none.
+	unsigned long get_frame_budget () const { return frame_budget; }
+
+	/*! Sets the time that the element's drawing should take in a frame.
+	 * If the average time taken by prepare() and redraw() for a
+	 * non-overlay element exceeds \a budget, in microseconds, they will
+	 * only be called every few frames. The element's recorded drawing will
+	 * be replayed in the other frames, as for a retained element. A budget
+	 * of zero, the default, disables this throttling. */
+	void set_frame_budget (unsigned long budget);
+
 	//! Returns the current drawing color.
 	Color get_drawing_color () const { return drawing_color; }
 
@@ -394,6 +723,15 @@ protected:
 	void draw_text (const String& text,
 		CanvasPoint position = CanvasPoint::ORIGIN);
 
+	/*! Draws a text layout on the element.
+	 * Each line of the layout will be drawn as by the draw_text() method
+	 * for strings. The line breaks are only recalculated if needed.
+	 * \param layout The text layout to be drawn. \param position The top
+	 * left corner of the layout's block, relative to the element.
+	 * \pre This method can only be called from redraw(). */
+	void draw_text (const TextLayout& layout,
+		CanvasPoint position = CanvasPoint::ORIGIN);
+
 	/*! Draws a bitmap image on the element.
 	 * \param bitmap The bitmap to draw. \param frame The frame of an
 	 * animated bitmap to draw, or HUDBitmap::STATIC for a static bitmap.
@@ -406,14 +744,31 @@ protected:
 		CanvasPoint position = CanvasPoint::ORIGIN,
 		CanvasRect clip = CanvasRect::NOCLIP);
 
+	/*! Draws several sprites from a sprite sheet on the element.
+	 * Sprites that are next to each other both in the sheet and as placed
+	 * are drawn together, so that drawing a row of neighboring sprites
+	 * takes a single engine call. \param sheet The sprite sheet to draw
+	 * from. \param placements The sprites to draw and their positions,
+	 * relative to the element. \param frame The frame of an animated
+	 * bitmap to draw, or HUDBitmap::STATIC for a static bitmap.
+	 * \pre This method can only be called from redraw(). */
+	void draw_sprites (const HUDSpriteSheet& sheet,
+		const std::vector<HUDSpriteSheet::Placement>& placements,
+		HUDBitmap::Frame frame = HUDBitmap::STATIC);
+
 	//@}
 	//! \name Calculations
 	//@{
 
 	/*! Calculates the canvas area required to draw the given text.
+	 * Measurements of recently used strings are cached.
 	 * \pre This method can only be called from prepare() or redraw(). */
 	CanvasSize get_text_size (const String& text) const;
 
+	/*! Calculates the canvas area required to draw the given text layout.
+	 * \pre This method can only be called from prepare() or redraw(). */
+	CanvasSize get_text_size (const TextLayout& layout) const;
+
 	/*! Returns the point on the canvas, if any, in the direction of the
 	 * given world location. If the direction of the location is offscreen,
 	 * returns CanvasPoint::OFFSCREEN. The location itself need not be
@@ -434,6 +789,25 @@ protected:
 	 * redraw(). */
 	CanvasPoint centroid_to_canvas (const Object& object) const;
 
+	/*! Returns the points on the canvas, if any, in the direction of each
+	 * of the given world locations, as location_to_canvas() would. A
+	 * location clearly outside the camera's field of view is returned as
+	 * CanvasPoint::OFFSCREEN without consulting the engine, so the cost of
+	 * this method grows mainly with the number of visible locations.
+	 * \pre This method can only be called from prepare() or redraw(). */
+	std::vector<CanvasPoint> project_many
+		(const std::vector<Vector>& locations) const;
+
+	/*! Returns the points on the canvas, if any, in the direction of the
+	 * centroids of each of the given objects, as centroid_to_canvas()
+	 * would. An object whose centroid lies more than \a margin DU outside
+	 * the camera's field of view is returned as CanvasPoint::OFFSCREEN
+	 * without consulting the engine further. Very large objects may need a
+	 * larger margin to be found when only their edges are visible.
+	 * \pre This method can only be called from prepare() or redraw(). */
+	std::vector<CanvasPoint> project_many (const Object::List& objects,
+		float margin = 8.0f) const;
+
 	//@}
 	//! \name Implemented by derived classes
 	//@{
@@ -450,7 +824,8 @@ protected:
 	 * A derived class must implement this method to perform the actual
 	 * drawing of the element. For a non-overlay element, the method will be
 	 * called in every frame where prepare() returns \c true; for an overlay
-	 * element, it will be called only in frames where a redraw is needed. */
+	 * or retained element, it will be called only in frames where a redraw
+	 * is needed. */
 	virtual void redraw () = 0;
 
 	//@}
@@ -463,6 +838,26 @@ private:
 
 	bool initialized, should_draw, needs_redraw, drawing;
 
+	// A drawing operation as recorded for a retained element.
+	struct DrawCommand
+	{
+		enum Type { COLOR, FILL, LINE, TEXT, BITMAP } type;
+		CanvasPoint from, to; // LINE endpoints; TEXT, BITMAP position
+		CanvasRect area; // FILL area; BITMAP clip
+		Color color;
+		String text;
+		HUDBitmap::Ptr bitmap;
+		HUDBitmap::Frame frame;
+	};
+
+	bool retained, recording;
+	std::vector<DrawCommand> display_list;
+	unsigned long frame_budget;
+
+	// Returns a new command to fill in if the drawing is being recorded.
+	DrawCommand* record (DrawCommand::Type type);
+	void execute (const DrawCommand& command) const;
+
 	typedef int Handle;
 	Handle overlay;
 	float opacity;
@@ -477,6 +872,30 @@ private:
 
 
 
+/*! A HUD element listing the drawing statistics of all HUD elements.
+ * This element is intended for debugging. It draws one line for each element
+ * registered with the central HUD handler (including itself), giving the
+ * element's class, priority, average and worst drawing times, frame budget, and
+ * current drawing interval. See HUDElementBase::get_stats(). */
+class HUDStatsDisplay : public HUDElement
+{
+public:
+	/*! Constructs and initializes a statistics display.
+	 * \param position The top left corner of the display. \param priority
+	 * The stacking priority of the display; by default, it is drawn above
+	 * all other elements. */
+	HUDStatsDisplay (CanvasPoint position = CanvasPoint (8, 8),
+		ZIndex priority = INT_MAX);
+
+	//! Destroys a statistics display.
+	virtual ~HUDStatsDisplay ();
+
+protected:
+	virtual void redraw ();
+};
+
+
+
 } // namespace Thief
 
 #include <Thief/HUD.inl>
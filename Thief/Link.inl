@@ -110,9 +110,9 @@ template <typename T>
 inline T
 Link::get_data_field (const String& field) const
 {
-	LGMulti<T> multi;
+	LGMulti<sMultiParm> multi; // filled by the engine
 	_get_data_field (field.empty () ? nullptr : field.data (), multi);
-	return multi;
+	return reinterpret_cast<const LGMulti<T>&> (multi);
 }
 
 template <typename T>
@@ -120,7 +120,7 @@ inline void
 Link::set_data_field (const String& field, const T& value)
 {
 	_set_data_field (field.empty () ? nullptr : field.data (),
-		LGMulti<T> (value));
+		LGMultiLocal<T> (value));
 }
 
 
@@ -38,8 +38,10 @@ namespace Thief {
  * can be used to cancel all future postings of the message. */
 struct Timer
 {
-	/*! The engine-internal ID number of the referenced timer.
-	 * This is not actually a pointer, and can be persisted. */
+	/*! The ID number of the referenced timer.
+	 * Timers of \c %Timer messages are usually multiplexed by ThiefLib
+	 * onto a single engine timer; other timers are engine-internal. In
+	 * either case, this is not actually a pointer, and can be persisted. */
 	void* id;
 
 	/*! Constructs a new timer reference.
@@ -87,6 +89,12 @@ struct Timer
  * additional data fields of fixed types which are relevant to their specific
  * meanings; those are implemented in classes descending from this one.
  *
+ * Each message type has a static \c matches() method that returns whether an
+ * engine message is of that type, and a static \c try_wrap() method that
+ * returns a wrapper for it (or an empty \c boost::optional if it is not of that
+ * type). Neither throws an exception, so they are preferable to the wrapping
+ * constructors when a message is expected to be of some other type.
+ *
  * \note Users of ThiefLib should not create classes inheriting from Message, as
  * the proper implementation of custom message types requires access to engine
  * internals not exposed by this library.
@@ -170,15 +178,29 @@ public:
 	 * For each link in the \a links list, the message will be conveyed
 	 * from the source of the link to the destination of the link. If \a
 	 * delay is greater than zero, the message will be schedule()d to each
-	 * recipient, otherwise it will be sent. */
-	void broadcast (const Link::List& links, Time delay = 0ul);
+	 * recipient, otherwise it will be sent.
+	 *
+	 * If \a queued is \c true and there is no delay, the sends are instead
+	 * handed to a delivery queue shared by all ThiefLib modules. The queue
+	 * is drained iteratively in breadth-first order before the outermost
+	 * queued broadcast returns, so any queued broadcasts made by the
+	 * recipients' handlers do not deepen the stack. The queue keeps its
+	 * own copy of the message name and data, and each recipient gets a
+	 * fresh message, so changes made by one handler are not seen by the
+	 * next. A message that would reach a recipient it was (indirectly)
+	 * caused by, under the same name, is skipped as a cycle, and delivery
+	 * stops (with a warning) after a fixed budget of messages. The #REPLY
+	 * slot is not available to queued recipients. Only messages created
+	 * as a GenericMessage can be queued; others are sent directly. */
+	void broadcast (const Link::List& links, Time delay = 0ul,
+		bool queued = false);
 
 	/*! Sends or schedules a message along links from the given object.
 	 * This is a convenience for calling broadcast() on a list of links
 	 * with a specific source (\a from) and flavor (\a link_flavor). See the
 	 * Link::List overload of broadcast() for more information. */
 	void broadcast (const Object& from, const Flavor& link_flavor,
-		Time delay = 0ul);
+		Time delay = 0ul, bool queued = false);
 
 	//@}
 	//! \name Generic data
@@ -225,13 +247,18 @@ protected:
 	sScrMsg* const message;
 
 	virtual bool is_postable () const;
+	virtual bool is_generic () const;
 
 	template <typename, typename> friend struct ScriptMessageHandler;
 
 	//! \endcond
 
 private:
-	void _get_data (Slot, LGMultiBase& value) const;
+	friend class Script;
+	Timer _schedule (const Object& from, const Object& to, Time delay,
+		bool repeating, const Object& host, Time now);
+
+	const LGMultiBase& _get_data (Slot) const;
 	void _set_data (Slot, const LGMultiBase& value);
 
 	void _get_reply (LGMultiBase& value) const;
@@ -244,7 +271,10 @@ private:
 
 
 //! \cond HIDDEN_SYMBOLS
-#define THIEF_MESSAGE_WRAP(Type) Type (sScrMsg*, sMultiParm*);
+#define THIEF_MESSAGE_WRAP(Type) \
+	Type (sScrMsg*, sMultiParm*); \
+	static bool matches (sScrMsg*); \
+	static boost::optional<Type> try_wrap (sScrMsg*, sMultiParm* = nullptr);
 //! \endcond
 
 
@@ -306,6 +336,10 @@ public:
 	template <typename D1, typename D2 = Empty, typename D3 = Empty>
 	static GenericMessage with_data (const char* name, const D1& data1,
 		const D2& data2 = D2 (), const D3& data3 = D3 ());
+
+private:
+	virtual bool is_generic () const;
+	bool created; // rather than wrapped, so no other fields
 };
 
 
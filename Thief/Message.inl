@@ -38,9 +38,7 @@ template <typename T>
 inline T
 Message::get_data (Slot slot) const
 {
-	LGMulti<T> multi;
-	_get_data (slot, multi);
-	return multi;
+	return reinterpret_cast<const LGMulti<T>&> (_get_data (slot));
 }
 
 template <typename T>
@@ -48,11 +46,7 @@ inline T
 Message::get_data (Slot slot, const T& default_value) const
 {
 	if (has_data (slot))
-	{
-		LGMulti<T> multi;
-		_get_data (slot, multi);
-		return multi;
-	}
+		return reinterpret_cast<const LGMulti<T>&> (_get_data (slot));
 	else
 		return default_value;
 }
@@ -61,7 +55,7 @@ template <typename T>
 inline void
 Message::set_data (Slot slot, const T& value)
 {
-	_set_data (slot, LGMulti<T> (value));
+	_set_data (slot, LGMultiLocal<T> (value));
 }
 
 template <typename D1, typename D2, typename D3>
@@ -65,9 +65,9 @@ template <typename T>
 inline T
 ObjectProperty::get () const
 {
-	LGMulti<T> value;
+	LGMulti<sMultiParm> value; // filled by the engine
 	_get (value);
-	return value;
+	return reinterpret_cast<const LGMulti<T>&> (value);
 }
 
 template <typename T>
@@ -76,9 +76,9 @@ ObjectProperty::get (const T& default_value) const
 {
 	if (exists ())
 	{
-		LGMulti<T> value;
+		LGMulti<sMultiParm> value; // filled by the engine
 		_get (value);
-		return value;
+		return reinterpret_cast<const LGMulti<T>&> (value);
 	}
 	else
 		return default_value;
@@ -88,16 +88,16 @@ template <typename T>
 inline void
 ObjectProperty::set (const T& value)
 {
-	_set (LGMulti<T> (value));
+	_set (LGMultiLocal<T> (value));
 }
 
 template <typename T>
 inline T
 ObjectProperty::get_field (const String& field) const
 {
-	LGMulti<T> value;
+	LGMulti<sMultiParm> value; // filled by the engine
 	_get_field (field.empty () ? nullptr : field.data (), value);
-	return value;
+	return reinterpret_cast<const LGMulti<T>&> (value);
 }
 
 template <typename T>
@@ -106,9 +106,9 @@ ObjectProperty::get_field (const String& field, const T& default_value) const
 {
 	if (exists ())
 	{
-		LGMulti<T> value;
+		LGMulti<sMultiParm> value; // filled by the engine
 		_get_field (field.empty () ? nullptr : field.data (), value);
-		return value;
+		return reinterpret_cast<const LGMulti<T>&> (value);
 	}
 	else
 		return default_value;
@@ -119,7 +119,7 @@ inline void
 ObjectProperty::set_field (const String& field, const T& value)
 {
 	_set_field (field.empty () ? nullptr : field.data (),
-		LGMulti<T> (value), false);
+		LGMultiLocal<T> (value), false);
 }
 
 
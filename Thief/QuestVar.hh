@@ -411,7 +411,10 @@ public:
 
 private:
 	typedef std::pair<Objective::Number, Field> ParseResult;
-	static ParseResult parse (const char* quest_var);
+	typedef std::unordered_map<String, ParseResult> QuestVars;
+	static QuestVars& get_quest_vars ();
+	static const ParseResult& parse (const char* quest_var);
+	static ParseResult parse_uncached (const String& quest_var);
 };
 
 
@@ -123,6 +123,95 @@ public:
 
 
 
+/*! The state of a running multi-step script task.
+ * A script task is a sequence of steps, each a method of the script class,
+ * that together carry out a long behavior such as an animated sequence or a
+ * conversation with the player. After each step, the task waits for a time to
+ * pass or a message to arrive before the next step runs. Tasks take the place
+ * of hand-written state machines over several Persistent variables and timers.
+ *
+ * The state of a task, including the next step and any values set with set_value(),
+ * is stored as a single persistent variable of the script. It is only written
+ * when the task begins to wait, so a task resumes correctly after a saved game
+ * is loaded. See Script::listen_task() and Script::start_task().
+ *
+ * Each step method receives the task state and returns one of the wait
+ * conditions from next(), sleep(), message(), or finish(). */
+class ScriptTask
+{
+public:
+	//! A condition for which a task waits before running its next step.
+	class Await
+	{
+	private:
+		friend class ScriptTask;
+		friend class Script;
+
+		enum Kind { NEXT, SLEEP, MESSAGE, FINISH };
+		Await (Kind kind, Time delay = 0ul,
+			const CIString& message = CIString ());
+
+		Kind kind;
+		Time delay;
+		CIString message;
+	};
+
+	//! Returns the name of the task.
+	const String& get_name () const { return name; }
+
+	//! Returns the index of the step now running, starting at zero.
+	size_t get_step () const { return step; }
+
+	/*! Makes the step at the given index the next to run, instead of the
+	 * one following the current step. */
+	void jump (size_t step);
+
+	//! Returns whether the named task value is set.
+	bool has_value (const String& key) const;
+
+	/*! Returns the named task value, or the given default if it is not
+	 * set. Task values are saved along with the rest of the task state. */
+	String get_value (const String& key,
+		const String& default_value = String ()) const;
+
+	//! Sets the named task value.
+	void set_value (const String& key, const String& value);
+
+	//! Runs the next step immediately.
+	Await next () const;
+
+	//! Runs the next step after the given time has elapsed.
+	Await sleep (Time duration) const;
+
+	/*! Runs the next step when the script next receives a message of the
+	 * given name, after any of its message handlers. A message that is
+	 * being handled when the wait begins does not end it. */
+	Await message (const CIString& name) const;
+
+	//! Ends the task. No more steps will be run.
+	Await finish () const;
+
+private:
+	friend class Script;
+
+	ScriptTask (const String& name);
+
+	String encode () const;
+	void decode (const String& raw);
+
+	String name;
+	size_t step, next_step;
+	unsigned generation;
+	Await::Kind waiting;
+	CIString waiting_for;
+	unsigned long waiting_since; // the dispatch in which the wait began
+
+	typedef std::map<String, String> Values;
+	Values values;
+};
+
+
+
 /*! Base class for all custom scripts.
  * A Dark %Engine object script is a C++ class implementing the engine's IScript
  * interface, included in a DLL bundled with the original game or a fan mission.
@@ -176,6 +265,16 @@ public:
 	 * object without a local variable. */
 	template <typename T, typename = THIEF_IS_OBJECT> T host_as () const;
 
+	/*! Outputs the dispatch profile of this script module to the monolog.
+	 * If ThiefLib was built with profiling enabled (\c make \c PROFILE=1),
+	 * the call counts and latencies of message handling are recorded for
+	 * each script class, message name, and handler. Those records are
+	 * reported here and, if a \a path is given, written to that file as
+	 * well. In such builds, sending a \c DumpProfile message to any
+	 * ThiefLib script has the same effect without a file, once for each
+	 * script module on the object. In other builds, this does nothing. */
+	static void dump_profile (const String& path = String ());
+
 	//! \cond HIDDEN_SYMBOLS
 	IScript* get_interface ();
 	//! \endcond
@@ -238,7 +337,16 @@ protected:
 	 * that library's <a href="http://www.boost.org/doc/libs/release/libs/format/doc/format.html#syntax">
 	 * format string syntax</a>.
 	 * \param ... Any additional arguments are substituted into the format
-	 * string in sequence. */
+	 * string in sequence.
+	 * \note To keep logging out of the message handling path, the message is
+	 * only recorded here. It is formatted and output once the script
+	 * module finishes handling the current engine message, or earlier if
+	 * output is sent to mono() or Monolog::log() in the meantime. Output
+	 * streamed directly to Thief::mono, or sent by another module, is not
+	 * ordered with recorded messages. The format and any string arguments
+	 * are copied when recorded. Numbers, strings, and objects are
+	 * substituted at output time; arguments of any other type are
+	 * converted to strings immediately. */
 	template <typename... Args>
 	void log (Log level, const String& format, const Args&...) const;
 
@@ -296,18 +404,125 @@ protected:
 	Timer start_timer (const char* timer, Time delay, bool repeating,
 		const T& data);
 
+	/*! Listens for steps of the named cooperative job, to be handled by the
+	 * given method. A job is a long piece of work, such as a sweep over
+	 * many objects or links, that is performed in small steps spread
+	 * across frames. The handler should perform one step, advance the
+	 * \a cursor (which starts at zero), and return whether any work
+	 * remains. The cursor is kept in a persistent variable between
+	 * frames, so the job resumes where it left off after a saved game is
+	 * loaded. Like the other listen methods, this is usually called in a
+	 * script's constructor.
+	 * \param job The name of the job.
+	 * \param step A pointer to a member function of the script class. */
+	template <typename _Script>
+	void listen_job (const CIString& job, bool (_Script::*step) (int& cursor));
+
+	/*! Starts the named cooperative job, or restarts it from the beginning
+	 * if it is already running. Steps of the job will be run as time
+	 * allows, starting with the next frame. A round of steps runs at most
+	 * once every 10 milliseconds of sim time: every frame at frame rates
+	 * up to 100 per second, and every second frame or so above that. All
+	 * jobs in a mission share a common time budget for each frame.
+	 * \param job The name of a job listened for with listen_job().
+	 * \param budget The most time, in microseconds, that the job should
+	 * take in any one frame. At least one step is taken in each frame
+	 * that the job runs, however long it takes. */
+	void start_job (const String& job, unsigned long budget = 1000ul);
+
+	/*! Stops the named cooperative job if it is running.
+	 * \return Whether the job had been running. */
+	bool stop_job (const String& job);
+
+	/*! Listens for the named task, whose steps are handled by the given
+	 * methods in order. See ScriptTask for more information. Like the other
+	 * listen methods, this is usually called in a script's constructor.
+	 * \param task The name of the task.
+	 * \param steps Pointers to member functions of the script class. */
+	template <typename _Script>
+	void listen_task (const CIString& task,
+		std::initializer_list<ScriptTask::Await (_Script::*)
+			(ScriptTask&)> steps);
+
+	/*! Starts the named task, or restarts it from its first step if it is
+	 * already running. The first step runs immediately. */
+	void start_task (const String& task);
+
+	/*! Stops the named task if it is running.
+	 * \return Whether the task had been running. */
+	bool stop_task (const String& task);
+
 private:
 	void fix_player_links ();
 
-	template <typename T, typename... Args>
-	void log_step (Log level, boost::format& format, const T& arg,
-		const Args&...) const;
-	void log_step (Log level, boost::format& format) const;
+	Monolog& mono_prefix (Log level, Time time) const;
+
+	struct LogArg
+	{
+		enum Type { NONE, BOOL, CHAR, SIGNED, UNSIGNED, REAL, TEXT, OBJECT };
+
+		LogArg () : type (NONE), signed_value (0) {}
+		LogArg (bool value) : type (BOOL), signed_value (value) {}
+		LogArg (char value) : type (CHAR), signed_value (value) {}
+		LogArg (signed char value) : type (CHAR), signed_value (value) {}
+		LogArg (unsigned char value) : type (CHAR), signed_value (value) {}
+		LogArg (int value) : type (SIGNED), signed_value (value) {}
+		LogArg (long value) : type (SIGNED), signed_value (value) {}
+		LogArg (long long value) : type (SIGNED), signed_value (value) {}
+		LogArg (unsigned value) : type (UNSIGNED), unsigned_value (value) {}
+		LogArg (unsigned long value)
+			: type (UNSIGNED), unsigned_value (value) {}
+		LogArg (unsigned long long value)
+			: type (UNSIGNED), unsigned_value (value) {}
+		LogArg (double value) : type (REAL), real_value (value) {}
+		LogArg (long double value) : type (REAL), real_value (value) {}
+		LogArg (const char* value)
+			: type (TEXT), signed_value (0), text (value ? value : "") {}
+		LogArg (const String& value)
+			: type (TEXT), signed_value (0), text (value) {}
+		LogArg (const Object& value)
+			: type (OBJECT), signed_value (value.number) {}
+
+		template <typename T, typename = typename std::enable_if
+			<!std::is_arithmetic<T>::value &&
+			 !std::is_base_of<Object, T>::value>::type>
+		LogArg (const T& value);
+
+		Type type;
+		union
+		{
+			long long signed_value;
+			unsigned long long unsigned_value;
+			double real_value;
+		};
+		String text;
+	};
+
+	class LogBuffer;
+	friend class LogBuffer;
+	void defer_log (Log level, const String& format, const LogArg* args,
+		size_t count) const;
 
 	typedef std::multimap<CIString, MessageHandler::Ptr> Handlers;
 	Handlers message_handlers;
 	Handlers timer_handlers;
 
+	typedef std::function<bool (Script&, int&)> JobStep;
+	typedef std::map<CIString, JobStep> JobSteps;
+	JobSteps job_steps;
+	void run_job (const String& job);
+
+	typedef std::function<ScriptTask::Await (Script&, ScriptTask&)>
+		TaskStep;
+	typedef std::map<CIString, std::vector<TaskStep>> TaskSteps;
+	TaskSteps task_steps;
+	typedef std::map<CIString, ScriptTask> Tasks;
+	Tasks tasks; // those running, as loaded from persistent variables
+	void load_tasks ();
+	unsigned next_task_generation (const String& task);
+	void run_task (const CIString& task);
+	void resume_tasks (const CIString& message, unsigned long dispatch);
+
 	bool dispatch (sScrMsg& message, sMultiParm* reply, unsigned trace);
 	bool dispatch_cycle (Handlers& candidates, const CIString& key,
 		sScrMsg& message, sMultiParm* reply);
@@ -529,8 +744,11 @@ protected:
 	 * ScriptHost::trap_invert flags. If \c true, the message will only be
 	 * sent if allowed by the first two flags, and its sense will be
 	 * inverted if required by the third flag. This is the behavior of the
-	 * standard button and lever scripts. */
-	void trigger (bool on, bool conditional = true, bool filtered = false);
+	 * standard button and lever scripts. \param queued Whether to convey
+	 * the message through the breadth-first delivery queue; see
+	 * Message::broadcast(). */
+	void trigger (bool on, bool conditional = true, bool filtered = false,
+		bool queued = false);
 
 	/*! Handles a processed \c TurnOn or \c TurnOff message on a trap.
 	 * Derived scripts with trap behavior should override this method to
@@ -94,27 +94,24 @@ Script::host_as () const
 
 template <typename... Args>
 inline void
-Script::log (Log level, const String& _format, const Args&... args) const
+Script::log (Log level, const String& format, const Args&... args) const
 {
 	if (int (level) >= int (min_level))
 	{
-		boost::format format { _format };
-		log_step (level, format, args...);
+		// The leading empty argument allows for an empty pack.
+		const LogArg _args [] = { LogArg (), LogArg (args)... };
+		defer_log (level, format, _args + 1, sizeof... (args));
 	}
 }
 
-template <typename T, typename... Args>
-inline void
-Script::log_step (Log level, boost::format& format, const T& arg,
-	const Args&... args) const
-{
-	log_step (level, format % arg, args...);
-}
-
-inline void
-Script::log_step (Log level, boost::format& format) const
+template <typename T, typename>
+inline
+Script::LogArg::LogArg (const T& value)
+	: type (TEXT), signed_value (0)
 {
-	mono (level) << format.str () << std::endl;
+	std::ostringstream _text;
+	_text << value;
+	text = _text.str ();
 }
 
 template <typename _Script, typename _Message>
@@ -155,7 +152,28 @@ inline Timer
 Script::start_timer (const char* timer, Time delay, bool repeating,
 	const T& data)
 {
-	return _start_timer (timer, delay, repeating, LGMulti<T> (data));
+	return _start_timer (timer, delay, repeating, LGMultiLocal<T> (data));
+}
+
+template <typename _Script>
+inline void
+Script::listen_job (const CIString& job, bool (_Script::*step) (int& cursor))
+{
+	job_steps [job] = [step] (Script& script, int& cursor)
+		{ return (static_cast<_Script&> (script).*step) (cursor); };
+}
+
+template <typename _Script>
+inline void
+Script::listen_task (const CIString& task,
+	std::initializer_list<ScriptTask::Await (_Script::*) (ScriptTask&)>
+		steps)
+{
+	std::vector<TaskStep>& _steps = task_steps [task];
+	_steps.clear ();
+	for (auto step : steps)
+		_steps.emplace_back ([step] (Script& script, ScriptTask& _task)
+			{ return (static_cast<_Script&> (script).*step) (_task); });
 }
 
 
@@ -222,7 +240,7 @@ inline Persistent<T>&
 Persistent<T>::operator = (const T& _value)
 {
 	value = _value;
-	set (LGMulti<T> (value));
+	set (LGMultiLocal<T> (value));
 	return *this;
 }
 
@@ -242,9 +260,9 @@ Persistent<T>::get_value () const
 		value = default_value;
 	else
 	{
-		LGMulti<T> _value;
+		LGMulti<sMultiParm> _value; // filled by the engine
 		get (_value);
-		value = _value;
+		value = reinterpret_cast<const LGMulti<T>&> (_value);
 	}
 }
 
@@ -135,13 +135,13 @@ AI::is_ai () const
 size_t
 AI::count_ais ()
 {
-	return SInterface<IAIManager> (LG)->CountAIs ();
+	return cached_interface<IAIManager> ()->CountAIs ();
 }
 
 AI::List
 AI::get_all_ais ()
 {
-	SInterface<IAIManager> AIM (LG);
+	IAIManager* AIM = cached_interface<IAIManager> ();
 	List everyone;
 	tAIIter iter;
 	for (IAI* ai = AIM->GetFirst (&iter); ai; ai = AIM->GetNext (&iter))
@@ -158,37 +158,37 @@ AI::get_all_ais ()
 bool
 AI::is_dead () const
 {
-	return SInterface<IAIManager> (LG)->GetAI (number)->IsDead ();
+	return cached_interface<IAIManager> ()->GetAI (number)->IsDead ();
 }
 
 bool
 AI::is_dying () const
 {
-	return SInterface<IAIManager> (LG)->GetAI (number)->IsDying ();
+	return cached_interface<IAIManager> ()->GetAI (number)->IsDying ();
 }
 
 void
 AI::set_mode_dead ()
 {
-	SInterface<IAIManager> (LG)->GetAI (number)->Kill ();
+	cached_interface<IAIManager> ()->GetAI (number)->Kill ();
 }
 
 void
 AI::set_mode_normal ()
 {
-	SInterface<IAIManager> (LG)->GetAI (number)->Resurrect ();
+	cached_interface<IAIManager> ()->GetAI (number)->Resurrect ();
 }
 
 void
 AI::freeze (Time duration)
 {
-	SInterface<IAIManager> (LG)->GetAI (number)->Freeze (duration);
+	cached_interface<IAIManager> ()->GetAI (number)->Freeze (duration);
 }
 
 void
 AI::unfreeze ()
 {
-	SInterface<IAIManager> (LG)->GetAI (number)->Unfreeze ();
+	cached_interface<IAIManager> ()->GetAI (number)->Unfreeze ();
 }
 
 
@@ -212,9 +212,9 @@ AI::_go_to_location (const Object& nearby, Speed speed, ActionPriority priority,
 	const LGMultiBase& result_data)
 {
 	LGBool result;
-	SService<IAIScrSrv> (LG)->MakeGotoObjLoc (result, number, nearby.number,
-		eAIScriptSpeed (speed), eAIActionPriority (priority),
-		result_data);
+	cached_service<IAIScrSrv> ()->MakeGotoObjLoc (result, number,
+		nearby.number, eAIScriptSpeed (speed),
+		eAIActionPriority (priority), result_data);
 	return result;
 }
 
@@ -248,11 +248,11 @@ AI::_frob_object (const Object& target, const Object& tool,
 {
 	LGBool result;
 	if (tool != Object::NONE)
-		SService<IAIScrSrv> (LG)->MakeFrobObjWith (result, number,
+		cached_service<IAIScrSrv> ()->MakeFrobObjWith (result, number,
 			target.number, tool.number, eAIActionPriority (priority),
 			result_data);
 	else
-		SService<IAIScrSrv> (LG)->MakeFrobObj (result, number,
+		cached_service<IAIScrSrv> ()->MakeFrobObj (result, number,
 			target.number, eAIActionPriority (priority),
 			result_data);
 	return result;
@@ -276,7 +276,7 @@ THIEF_ENUM_CODING (AI::Alert, BOTH, CODE,
 void
 AI::clear_alertness ()
 {
-	SService<IAIScrSrv> (LG)->ClearAlertness (number);
+	cached_service<IAIScrSrv> ()->ClearAlertness (number);
 }
 
 
@@ -294,7 +294,8 @@ bool
 AI::play_motion (const String& motion)
 {
 	LGBool result;
-	SService<IPuppetSrv> (LG)->PlayMotion (result, number, motion.data ());
+	cached_service<IPuppetSrv> ()->PlayMotion (result, number,
+		motion.data ());
 	return result;
 }
 
@@ -317,13 +318,13 @@ AI::play_motion (const String& motion)
 void
 AI::set_speech_enabled (bool enabled)
 {
-	SService<IAIScrSrv> (LG)->SetScriptFlags (number, enabled ? 0 : 1);
+	cached_service<IAIScrSrv> ()->SetScriptFlags (number, enabled ? 0 : 1);
 }
 
 void
 AI::halt_speech ()
 {
-	SService<ISoundScrSrv> (LG)->HaltSpeech (number);
+	cached_service<ISoundScrSrv> ()->HaltSpeech (number);
 }
 
 
@@ -333,7 +334,7 @@ AI::halt_speech ()
 void
 AI::send_signal (const String& signal)
 {
-	SService<IAIScrSrv> (LG)->Signal (number, signal.data ());
+	cached_service<IAIScrSrv> ()->Signal (number, signal.data ());
 }
 
 
@@ -364,7 +365,7 @@ bool
 Conversation::start_conversation ()
 {
 	LGBool result;
-	SService<IAIScrSrv> (LG)->StartConversation (result, number);
+	cached_service<IAIScrSrv> ()->StartConversation (result, number);
 	return result;
 }
 
@@ -374,7 +375,7 @@ AI
 Conversation::get_actor (size_t _number) const
 {
 	Object::Number _actor = Object::NONE.number;
-	return SInterface<IAIManager> (LG)->GetConversationManager ()->
+	return cached_interface<IAIManager> ()->GetConversationManager ()->
 		GetActorObj (number, _number - 1, &_actor) // zero-based
 			? Object (_actor) : Object::NONE;
 }
@@ -382,27 +383,29 @@ Conversation::get_actor (size_t _number) const
 void
 Conversation::set_actor (size_t _number, const Object& actor)
 {
-	SInterface<IAIManager> (LG)->GetConversationManager ()->
+	cached_interface<IAIManager> ()->GetConversationManager ()->
 		SetActorObj (number, _number, actor.number); // one-based
 }
 
 void
 Conversation::remove_actor (size_t _number)
 {
-	SInterface<IAIManager> (LG)->GetConversationManager ()->
+	cached_interface<IAIManager> ()->GetConversationManager ()->
 		RemoveActorObj (number, _number); // one-based
 }
 
 bool
 Conversation::subscribe (const Object& host)
 {
-	return SService<IOSLService> (LG)->subscribe_conversation (*this, host);
+	return cached_service<IOSLService> ()->subscribe_conversation (*this,
+		host);
 }
 
 bool
 Conversation::unsubscribe (const Object& host)
 {
-	return SService<IOSLService> (LG)->unsubscribe_conversation (*this, host);
+	return cached_service<IOSLService> ()->unsubscribe_conversation (*this,
+		host);
 }
 
 
@@ -619,7 +622,7 @@ MESSAGE_WRAPPER_IMPL (AIActionResultMessage, "ObjActResult"),
 
 AIActionResultMessage::AIActionResultMessage (Action _action, Result _result,
 		const Object& _target, const LGMultiBase& data)
-	: Message (new sAIObjActResultMsg ()), action (_action),
+	: Message (new PooledMessage<sAIObjActResultMsg> ()), action (_action),
 	  result (_result), target (_target)
 {
 	message->message = "ObjActResult";
@@ -649,8 +652,8 @@ MESSAGE_WRAPPER_IMPL_ (AIAlertnessMessage,
 AIAlertnessMessage::AIAlertnessMessage (AI::Alert _new_level,
 	AI::Alert _old_level, bool _high_alert)
 	: Message (high_alert
-		? static_cast<sScrMsg*> (new sAIHighAlertMsg ())
-		: static_cast<sScrMsg*> (new sAIAlertnessMsg ())),
+		? static_cast<sScrMsg*> (new PooledMessage<sAIHighAlertMsg> ())
+		: static_cast<sScrMsg*> (new PooledMessage<sAIAlertnessMsg> ())),
 	  high_alert (_high_alert), new_level (_new_level),
 	  old_level (_old_level)
 {
@@ -676,7 +679,8 @@ MESSAGE_WRAPPER_IMPL (AIModeMessage, "AIModeChange"),
 {}
 
 AIModeMessage::AIModeMessage (AI::Mode _new_mode, AI::Mode _old_mode)
-	: Message (new sAIModeChangeMsg ()), new_mode (_new_mode),
+	: Message (new PooledMessage<sAIModeChangeMsg> ()),
+	  new_mode (_new_mode),
 	  old_mode (_old_mode)
 {
 	message->message = "AIModeChange";
@@ -699,7 +703,8 @@ MESSAGE_WRAPPER_IMPL_ (AIMotionMessage,
 
 AIMotionMessage::AIMotionMessage (Event _event, const String& _motion,
 		int _motion_flag)
-	: Message (new sBodyMsg ()), event (_event), motion (_motion),
+	: Message (new PooledMessage<sBodyMsg> ()),
+	  event (_event), motion (_motion),
 	  motion_flag (_motion_flag)
 {
 	switch (event)
@@ -723,7 +728,8 @@ MESSAGE_WRAPPER_IMPL (AIPatrolPointMessage, "PatrolPoint"),
 {}
 
 AIPatrolPointMessage::AIPatrolPointMessage (const Object& _patrol_point)
-	: Message (new sAIPatrolPointMsg ()), patrol_point (_patrol_point)
+	: Message (new PooledMessage<sAIPatrolPointMsg> ()),
+	  patrol_point (_patrol_point)
 {
 	message->message = "PatrolPoint";
 	MESSAGE_AS (sAIPatrolPointMsg)->patrolObj = patrol_point.number;
@@ -738,7 +744,7 @@ MESSAGE_WRAPPER_IMPL (AISignalMessage, "SignalAI"),
 {}
 
 AISignalMessage::AISignalMessage (const String& _signal)
-	: Message (new sAISignalMsg ()), signal (_signal)
+	: Message (new PooledMessage<sAISignalMsg> ()), signal (_signal)
 {
 	message->message = "SignalAI";
 	MESSAGE_AS (sAISignalMsg)->signal = signal.data ();
@@ -753,7 +759,8 @@ MESSAGE_WRAPPER_IMPL (ConversationMessage, "ConversationEnd"),
 {}
 
 ConversationMessage::ConversationMessage (const Object& _conversation)
-	: Message (new ConversationMessageImpl ()), conversation (_conversation)
+	: Message (new PooledMessage<ConversationMessageImpl> ()),
+	  conversation (_conversation)
 {
 	message->message = "ConversationEnd";
 	MESSAGE_AS (ConversationMessageImpl)->conversation = conversation;
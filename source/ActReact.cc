@@ -35,7 +35,8 @@ const Reaction
 Reaction::NONE (0);
 
 Reaction::Reaction (const String& name)
-	: number (SService<IActReactSrv> (LG)->GetReactionNamed (name.data ()))
+	: number (cached_service<IActReactSrv> ()->GetReactionNamed
+		(name.data ()))
 {
 	if (*this == NONE)
 		throw MissingResource (MissingResource::REACTION, name,
@@ -46,7 +47,7 @@ String
 Reaction::get_name () const
 {
 	LGString name;
-	SService<IActReactSrv> (LG)->GetReactionName (name, number);
+	cached_service<IActReactSrv> ()->GetReactionName (name, number);
 	return name;
 }
 
@@ -90,7 +91,7 @@ Reagent::stimulate (const Stimulus& stimulus, float intensity,
 #ifndef IS_THIEF2
 	(void) source;
 #endif
-	SService<IActReactSrv> (LG)->Stimulate
+	cached_service<IActReactSrv> ()->Stimulate
 		(number, stimulus.number, intensity
 #ifdef IS_THIEF2
 		, source.number
@@ -103,14 +104,14 @@ Reagent::stimulate (const Stimulus& stimulus, float intensity,
 void
 Reagent::subscribe_stimulus (const Stimulus& stimulus)
 {
-	SService<IActReactSrv> (LG)->SubscribeToStimulus
+	cached_service<IActReactSrv> ()->SubscribeToStimulus
 		(number, stimulus.number);
 }
 
 void
 Reagent::unsubscribe_stimulus (const Stimulus& stimulus)
 {
-	SService<IActReactSrv> (LG)->UnsubscribeToStimulus
+	cached_service<IActReactSrv> ()->UnsubscribeToStimulus
 		(number, stimulus.number);
 }
 
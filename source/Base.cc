@@ -22,6 +22,8 @@
  *****************************************************************************/
 
 #include "Private.hh"
+#include <cstddef>
+#include <type_traits>
 
 namespace Thief {
 
@@ -388,16 +390,44 @@ LGMultiBase::~LGMultiBase ()
 	clear ();
 }
 
+#define THIEF_LGMULTI_CHECK_LAYOUT() \
+	static_assert (sizeof (LGMultiBase) == sizeof (sMultiParm), \
+		"LGMultiBase must have the size of sMultiParm"); \
+	static_assert (std::is_standard_layout<LGMultiBase>::value && \
+		std::is_standard_layout<sMultiParm>::value, \
+		"LGMultiBase and sMultiParm must have standard layout"); \
+	static_assert (offsetof (LGMultiBase, type) == \
+		offsetof (sMultiParm, type), \
+		"LGMultiBase::type must overlay sMultiParm::type")
+
 LGMultiBase::operator sMultiParm& ()
 {
+	THIEF_LGMULTI_CHECK_LAYOUT ();
 	return *reinterpret_cast<sMultiParm*> (this);
 }
 
 LGMultiBase::operator const sMultiParm& () const
 {
+	THIEF_LGMULTI_CHECK_LAYOUT ();
 	return *reinterpret_cast<const sMultiParm*> (this);
 }
 
+LGMultiBase&
+LGMultiBase::view (sMultiParm& multi)
+{
+	THIEF_LGMULTI_CHECK_LAYOUT ();
+	return *reinterpret_cast<LGMultiBase*> (&multi);
+}
+
+const LGMultiBase&
+LGMultiBase::view (const sMultiParm& multi)
+{
+	THIEF_LGMULTI_CHECK_LAYOUT ();
+	return *reinterpret_cast<const LGMultiBase*> (&multi);
+}
+
+#undef THIEF_LGMULTI_CHECK_LAYOUT
+
 LGMultiBase&
 LGMultiBase::operator = (const sMultiParm& copy)
 {
@@ -549,6 +579,7 @@ LGMULTI_SPECIALIZE_CTOR (String)
 LGMulti<String>&
 LGMulti<String>::operator = (const String& value)
 {
+	clear ();
 	data.p = alloc.alloc (value.size () + 1);
 	strcpy (static_cast<char*> (data.p), value.data ());
 	type = STRING;
@@ -588,6 +619,7 @@ LGMULTI_SPECIALIZE_CTOR (Vector)
 LGMulti<Vector>&
 LGMulti<Vector>::operator = (const Vector& value)
 {
+	clear ();
 	data.p = alloc.alloc (sizeof (mxs_vector));
 	memcpy (data.p, &value, sizeof (mxs_vector));
 	type = VECTOR;
@@ -618,6 +650,38 @@ LGMulti<Empty>::LGMulti (const Empty&)
 
 
 
+// LGMultiLocal
+
+LGMultiLocal<String>::LGMultiLocal (const String& value)
+{
+	if (value.size () < INLINE_SIZE)
+		data.p = buffer;
+	else
+		data.p = alloc.alloc (value.size () + 1);
+	strcpy (static_cast<char*> (data.p), value.data ());
+	type = STRING;
+}
+
+LGMultiLocal<String>::~LGMultiLocal ()
+{
+	if (data.p == buffer)
+		data.p = nullptr; // Keep LGMultiBase from freeing it.
+}
+
+LGMultiLocal<Vector>::LGMultiLocal (const Vector& value)
+	: buffer (value)
+{
+	data.p = &buffer;
+	type = VECTOR;
+}
+
+LGMultiLocal<Vector>::~LGMultiLocal ()
+{
+	data.p = nullptr; // Keep LGMultiBase from freeing it.
+}
+
+
+
 // FieldProxyConfig
 
 template<>
@@ -625,7 +689,7 @@ bool
 FieldProxyConfig<bool>::bitmask_getter (const Item& item,
 	const LGMultiBase& _multi)
 {
-	auto& multi = reinterpret_cast<const LGMulti<unsigned>&> (_multi);
+	auto& multi = static_cast<const LGMulti<unsigned>&> (_multi);
 
 	if (multi.empty ()) return item.default_value;
 
@@ -640,7 +704,7 @@ void
 FieldProxyConfig<bool>::bitmask_setter (const Item& item, LGMultiBase& _multi,
 	const bool& value)
 {
-	auto& multi = reinterpret_cast<LGMulti<unsigned>&> (_multi);
+	auto& multi = static_cast<LGMulti<unsigned>&> (_multi);
 
 	bool negate = item.detail < 0;
 	unsigned bitmask = std::abs (item.detail);
@@ -656,7 +720,7 @@ FieldProxyConfig<float>::component_getter (const Item& item,
 	const LGMultiBase& multi)
 {
 	return multi.empty () ? item.default_value
-		: Vector (reinterpret_cast<const LGMulti<Vector>&> (multi))
+		: Vector (static_cast<const LGMulti<Vector>&> (multi))
 			[Vector::Component (item.detail)];
 }
 
@@ -665,7 +729,7 @@ void
 FieldProxyConfig<float>::component_setter (const Item& item, LGMultiBase& _multi,
 	const float& value)
 {
-	auto& multi = reinterpret_cast<LGMulti<Vector>&> (_multi);
+	auto& multi = static_cast<LGMulti<Vector>&> (_multi);
 	Vector raw = multi;
 	raw [Vector::Component (item.detail)] = value;
 	multi = raw;
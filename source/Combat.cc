@@ -40,7 +40,8 @@ Blood::cleanse (const Vector& _center, float radius)
 {
 	Object center = Object::create_temp_fnord ();
 	center.set_location (_center);
-	SService<IDarkPowerupsSrv> (LG)->CleanseBlood (center.number, radius);
+	cached_service<IDarkPowerupsSrv> ()->CleanseBlood (center.number,
+		radius);
 }
 
 
@@ -113,7 +114,8 @@ MESSAGE_WRAPPER_IMPL_ (AIAttackMessage,
 }
 
 AIAttackMessage::AIAttackMessage (Event _event, const Object& _weapon)
-	: Message (new sAttackMsg ()), event (_event), weapon (_weapon)
+	: Message (new PooledMessage<sAttackMsg> ()),
+	  event (_event), weapon (_weapon)
 {
 	switch (event)
 	{
@@ -22,6 +22,7 @@
  *****************************************************************************/
 
 #include "Private.hh"
+#include <fstream>
 
 namespace Thief {
 
@@ -34,6 +35,11 @@ class Monolog::Streambuf : public std::streambuf
 public:
 	Streambuf (MPrintfProc proc);
 
+	void set_proc (MPrintfProc proc);
+	bool open_file (const String& path);
+	bool has_file () const;
+	bool has_proc () const;
+
 	void write (const char* string);
 
 protected:
@@ -46,6 +52,7 @@ private:
 	static const size_t BUFFER_SIZE = 1000u; // imposed by the engine
 	std::array<char_type, BUFFER_SIZE> buffer;
 	MPrintfProc proc;
+	std::ofstream file;
 };
 
 Monolog::Streambuf::Streambuf (MPrintfProc _proc)
@@ -55,6 +62,32 @@ Monolog::Streambuf::Streambuf (MPrintfProc _proc)
 	setp (&buffer.front (), &buffer.back ());
 }
 
+void
+Monolog::Streambuf::set_proc (MPrintfProc _proc)
+{
+	proc = _proc;
+}
+
+bool
+Monolog::Streambuf::open_file (const String& path)
+{
+	if (file.is_open ()) file.close ();
+	if (!path.empty ()) file.open (path.data (), std::ios::app);
+	return file.is_open ();
+}
+
+bool
+Monolog::Streambuf::has_file () const
+{
+	return file.is_open ();
+}
+
+bool
+Monolog::Streambuf::has_proc () const
+{
+	return proc;
+}
+
 Monolog::Streambuf::int_type
 Monolog::Streambuf::overflow (int_type ch)
 {
@@ -72,7 +105,9 @@ Monolog::Streambuf::overflow (int_type ch)
 int
 Monolog::Streambuf::sync ()
 {
-	return flush_to_mono () ? 0 : -1;
+	bool result = flush_to_mono ();
+	if (file.is_open ()) file.flush ();
+	return result ? 0 : -1;
 }
 
 bool
@@ -107,7 +142,7 @@ Monolog::Streambuf::flush_to_mono ()
 	pbump (current - front);
 
 	// Success if there was something for write() to do.
-	return proc || LG;
+	return proc || LG || file.is_open ();
 }
 
 inline void
@@ -118,10 +153,13 @@ Monolog::Streambuf::write (const char* string)
 	else if (LG)
 		try
 		{
-			SService<IDebugScrSrv> (LG)->MPrint
+			cached_service<IDebugScrSrv> ()->MPrint
 				(string,"","","","","","","");
 		}
 		catch (...) {}
+
+	if (file.is_open ())
+		file << string << '\n';
 }
 
 
@@ -134,6 +172,9 @@ mono;
 Monolog
 null_mono;
 
+Monolog::Hook
+Monolog::log_hook = nullptr;
+
 Monolog::Monolog ()
 	: std::ostream (), buf ()
 {}
@@ -144,20 +185,55 @@ Monolog::~Monolog ()
 void
 Monolog::attach (MPrintfProc proc)
 {
-	buf.reset (proc ? new Streambuf (proc) : nullptr);
+	if (buf && buf->has_file ())
+		buf->set_proc (proc); // Keep the file sink.
+	else
+		buf.reset (proc ? new Streambuf (proc) : nullptr);
 	rdbuf (buf.get ());
 }
 
+bool
+Monolog::attach_file (const String& path)
+{
+	if (buf)
+		flush ();
+	else if (path.empty ())
+		return false;
+	else
+	{
+		buf.reset (new Streambuf (nullptr));
+		rdbuf (buf.get ());
+	}
+	if (buf->open_file (path))
+		return true;
+	else if (!buf->has_proc ())
+	{
+		rdbuf (nullptr);
+		buf.reset ();
+	}
+	return false;
+}
+
 void
 Monolog::log (const String& message)
 {
-	if (buf) buf->write (message.data ());
+	if (!buf) return;
+	if (log_hook) log_hook ();
+	buf->write (message.data ());
 }
 
 void
 Monolog::log (const boost::format& message)
 {
-	if (buf) buf->write (message.str ().data ());
+	if (!buf) return;
+	if (log_hook) log_hook ();
+	buf->write (message.str ().data ());
+}
+
+void
+Monolog::set_log_hook (Hook hook)
+{
+	log_hook = hook;
 }
 
 
@@ -232,7 +308,7 @@ String
 Engine::get_app_name ()
 {
 	LGString name;
-	SService<IVersionSrv> (LG)->GetAppName (true, name);
+	cached_service<IVersionSrv> ()->GetAppName (true, name);
 	return name;
 }
 
@@ -240,7 +316,7 @@ String
 Engine::get_long_app_name ()
 {
 	LGString name;
-	SService<IVersionSrv> (LG)->GetAppName (false, name);
+	cached_service<IVersionSrv> ()->GetAppName (false, name);
 	return name;
 }
 
@@ -248,7 +324,8 @@ Version
 Engine::get_version ()
 {
 	Version version (0, 0);
-	SService<IVersionSrv> (LG)->GetVersion (version.major, version.minor);
+	cached_service<IVersionSrv> ()->GetVersion (version.major,
+		version.minor);
 	return version;
 }
 
@@ -259,7 +336,7 @@ Engine::get_version ()
 Engine::Mode
 Engine::get_mode ()
 {
-	switch (SService<IVersionSrv> (LG)->IsEditor ())
+	switch (cached_service<IVersionSrv> ()->IsEditor ())
 	{
 	case 1: return Mode::EDIT;
 	default: return Mode::GAME;
@@ -269,13 +346,13 @@ Engine::get_mode ()
 bool
 Engine::is_editor ()
 {
-	return SService<IVersionSrv> (LG)->IsEditor () != 0;
+	return cached_service<IVersionSrv> ()->IsEditor () != 0;
 }
 
 bool
 Engine::is_sim ()
 {
-	return SInterface<ISimManager> (LG)->LastMsg ()
+	return cached_interface<ISimManager> ()->LastMsg ()
 		& (kSimStart | kSimResume);
 }
 
@@ -287,27 +364,28 @@ CanvasSize
 Engine::get_canvas_size ()
 {
 	CanvasSize size;
-	SService<IEngineSrv> (LG)->GetCanvasSize (size.w, size.h);
+	cached_service<IEngineSrv> ()->GetCanvasSize (size.w, size.h);
 	return size;
 }
 
 float
 Engine::get_aspect_ratio ()
 {
-	return SService<IEngineSrv> (LG)->GetAspectRatio ();
+	return cached_service<IEngineSrv> ()->GetAspectRatio ();
 }
 
 int
 Engine::get_directx_version ()
 {
-	return SService<IEngineSrv> (LG)->IsRunningDX6 () ? 6 : 9;
+	return cached_service<IEngineSrv> ()->IsRunningDX6 () ? 6 : 9;
 }
 
 bool
 Engine::rendered_this_frame (const Object& object)
 {
 	LGBool rendered;
-	SService<IObjectSrv> (LG)->RenderedThisFrame (rendered, object.number);
+	cached_service<IObjectSrv> ()->RenderedThisFrame (rendered,
+		object.number);
 	return rendered;
 }
 
@@ -319,13 +397,14 @@ Engine::raycast (RaycastMode mode, const Vector& from, const Vector& to,
 	LGVector location;
 	LGObject object;
 	if (mode == RaycastMode::TERRAIN)
-		type = SService<IEngineSrv> (LG)->PortalRaycast
+		type = cached_service<IEngineSrv> ()->PortalRaycast
 			(LGVector (from), LGVector (to), location)
 				? RaycastHit::TERRAIN : RaycastHit::NONE;
 	else
-		type = SService<IEngineSrv> (LG)->ObjRaycast (LGVector (from),
-			LGVector (to), location, object, eObjRaycast (mode),
-			!include_mesh, Object::NONE.number, Object::NONE.number);
+		type = cached_service<IEngineSrv> ()->ObjRaycast
+			(LGVector (from), LGVector (to), location, object,
+			eObjRaycast (mode), !include_mesh,
+			Object::NONE.number, Object::NONE.number);
 	return { RaycastHit::Type (type), location, object };
 }
 
@@ -337,12 +416,12 @@ Engine::raycast (RaycastMode mode, const Object& from, const Object& to,
 	LGVector location;
 	LGObject object;
 	if (mode == RaycastMode::TERRAIN)
-		type = SService<IEngineSrv> (LG)->PortalRaycast
+		type = cached_service<IEngineSrv> ()->PortalRaycast
 			(LGVector (from.get_location ()),
 			LGVector (to.get_location ()), location)
 				? RaycastHit::TERRAIN : RaycastHit::NONE;
 	else
-		type = SService<IEngineSrv> (LG)->ObjRaycast
+		type = cached_service<IEngineSrv> ()->ObjRaycast
 			(LGVector (from.get_location ()),
 			LGVector (to.get_location ()),
 			location, object, eObjRaycast (mode), !include_mesh,
@@ -357,7 +436,8 @@ Engine::raycast (RaycastMode mode, const Object& from, const Object& to,
 bool
 Engine::has_config (const String& variable)
 {
-	return SService<IEngineSrv> (LG)->ConfigIsDefined (variable.data ());
+	return cached_service<IEngineSrv> ()->ConfigIsDefined
+		(variable.data ());
 }
 
 template<>
@@ -365,7 +445,8 @@ int
 Engine::get_config (const String& variable)
 {
 	int value = 0;
-	if (!SService<IEngineSrv> (LG)->ConfigGetInt (variable.data (), value))
+	if (!cached_service<IEngineSrv> ()->ConfigGetInt (variable.data (),
+		value))
 		throw std::runtime_error ("could not get config variable");
 	return value;
 }
@@ -375,7 +456,8 @@ float
 Engine::get_config (const String& variable)
 {
 	float value = 0.0f;
-	if (!SService<IEngineSrv> (LG)->ConfigGetFloat (variable.data (), value))
+	if (!cached_service<IEngineSrv> ()->ConfigGetFloat (variable.data (),
+		value))
 		throw std::runtime_error ("could not get config variable");
 	return value;
 }
@@ -385,7 +467,8 @@ String
 Engine::get_config (const String& variable)
 {
 	LGString value;
-	if (!SService<IEngineSrv> (LG)->ConfigGetRaw (variable.data (), value))
+	if (!cached_service<IEngineSrv> ()->ConfigGetRaw (variable.data (),
+		value))
 		throw std::runtime_error ("could not get config variable");
 	return value;
 }
@@ -393,14 +476,15 @@ Engine::get_config (const String& variable)
 float
 Engine::get_binding_config (const String& variable)
 {
-	return SService<IEngineSrv> (LG)->BindingGetFloat (variable.data ());
+	return cached_service<IEngineSrv> ()->BindingGetFloat
+		(variable.data ());
 }
 
 bool
 Engine::is_command_bound (const String& command)
 {
 	LGBool bound;
-	SService<IDarkUISrv> (LG)->IsCommandBound (bound, command.data ());
+	cached_service<IDarkUISrv> ()->IsCommandBound (bound, command.data ());
 	return bound;
 }
 
@@ -410,7 +494,8 @@ Engine::get_command_binding (const String& command)
 	if (!is_command_bound (command))
 		return String ();
 	LGString binding;
-	SService<IDarkUISrv> (LG)->DescribeKeyBinding (binding, command.data ());
+	cached_service<IDarkUISrv> ()->DescribeKeyBinding (binding,
+		command.data ());
 	return binding;
 }
 
@@ -423,7 +508,7 @@ String
 Engine::find_file_in_path (const String& type, const String& file)
 {
 	LGString _path;
-	bool found = SService<IEngineSrv> (LG)->FindFileInPath
+	bool found = cached_service<IEngineSrv> ()->FindFileInPath
 		(type.data (), file.data (), _path);
 	return found ? (const char*) _path : "";
 }
@@ -431,33 +516,33 @@ Engine::find_file_in_path (const String& type, const String& file)
 int
 Engine::random_int (int minimum, int maximum)
 {
-	return SService<IDataSrv> (LG)->RandInt (minimum, maximum);
+	return cached_service<IDataSrv> ()->RandInt (minimum, maximum);
 }
 
 float
 Engine::random_float ()
 {
-	return SService<IDataSrv> (LG)->RandFlt0to1 ();
+	return cached_service<IDataSrv> ()->RandFlt0to1 ();
 }
 
 float
 Engine::random_float (float minimum, float maximum)
 {
 	return minimum + (maximum - minimum) *
-		SService<IDataSrv> (LG)->RandFlt0to1 ();
+		cached_service<IDataSrv> ()->RandFlt0to1 ();
 }
 
 void
 Engine::run_command (const String& command, const String& arguments)
 {
-	SService<IDebugScrSrv> (LG)->Command
+	cached_service<IDebugScrSrv> ()->Command
 		(command.data (), arguments.data (), "", "", "", "", "", "");
 }
 
 void
 Engine::write_to_game_log (const String& message)
 {
-	SService<IDebugScrSrv> (LG)->Log
+	cached_service<IDebugScrSrv> ()->Log
 		(message.data (), "", "", "", "", "", "", "");
 }
 
@@ -470,7 +555,7 @@ MESSAGE_WRAPPER_IMPL (GameModeMessage, "DarkGameModeChange"),
 {}
 
 GameModeMessage::GameModeMessage (Event _event)
-	: Message (new sDarkGameModeScrMsg ()), event (_event)
+	: Message (new PooledMessage<sDarkGameModeScrMsg> ()), event (_event)
 {
 	message->message = "DarkGameModeChange";
 	MESSAGE_AS (sDarkGameModeScrMsg)->fResuming = (event == RESUME);
@@ -486,7 +571,7 @@ MESSAGE_WRAPPER_IMPL (SimMessage, "Sim"),
 {}
 
 SimMessage::SimMessage (Event _event)
-	: Message (new sSimMsg ()), event (_event)
+	: Message (new PooledMessage<sSimMsg> ()), event (_event)
 {
 	message->message = "Sim";
 	MESSAGE_AS (sSimMsg)->fStarting = (event == START);
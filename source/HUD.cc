@@ -24,6 +24,7 @@
 #include "Private.hh"
 #include "OSL.hh"
 
+#include <fstream>
 #include <windows.h>
 #undef DrawText // ugh, Windows...
 #undef GetClassName // ugh, Windows...
@@ -52,7 +53,7 @@ CanvasPoint::valid () const
 bool
 CanvasPoint::onscreen () const
 {
-	CanvasSize canvas = Engine::get_canvas_size ();
+	const CanvasSize& canvas = HUDFrameContext::get ().canvas_size;
 	return valid () && x < canvas.w && y < canvas.h;
 }
 
@@ -122,7 +123,7 @@ CanvasRect::valid () const
 bool
 CanvasRect::onscreen (bool allow_partial) const
 {
-	CanvasSize canvas = Engine::get_canvas_size ();
+	const CanvasSize& canvas = HUDFrameContext::get ().canvas_size;
 	if (*this == NOCLIP)
 		return true;
 	else if (allow_partial)
@@ -135,6 +136,21 @@ CanvasRect::onscreen (bool allow_partial) const
 
 
 
+// HUDFrameContext
+
+HUDFrameContext::HUDFrameContext ()
+	: number (0ul), aspect_ratio (0.0f), field_of_view (0.0f),
+	  camera_known (false)
+{}
+
+const HUDFrameContext&
+HUDFrameContext::get ()
+{
+	return cached_service<IOSLService> ()->get_hud_frame ();
+}
+
+
+
 // HUDBitmap
 
 #define MAX_BITMAP_HANDLE 128
@@ -145,53 +161,212 @@ HUDBitmap::STATIC = 0;
 HUDBitmap::Ptr
 HUDBitmap::load (const String& path, bool animation)
 {
-	return SService<IOSLService> (LG)->load_hud_bitmap (path, animation);
+	return cached_service<IOSLService> ()->load_hud_bitmap (path,
+		animation);
+}
+
+size_t
+HUDBitmap::preload (const std::vector<String>& paths, bool animation)
+{
+	IOSLService* OSL = cached_service<IOSLService> ();
+	size_t loaded = 0;
+	for (auto& path : paths)
+		if (OSL->preload_hud_bitmap (path, animation))
+			++loaded;
+	return loaded;
+}
+
+HUDBitmap::CacheStats
+HUDBitmap::get_cache_stats ()
+{
+	return cached_service<IOSLService> ()->get_hud_bitmap_cache_stats ();
+}
+
+void
+HUDBitmap::set_cache_limit (Frame frames)
+{
+	cached_service<IOSLService> ()->set_hud_bitmap_cache_limit (frames);
+}
+
+// Reads the frame file names from an animation's manifest, if it has one.
+static bool
+read_frame_manifest (const String& base, std::vector<String>& files)
+{
+	String manifest = Engine::find_file_in_path ("resname_base",
+		base + ".frames");
+	if (manifest.empty ()) return false;
+
+	std::ifstream input (manifest.data ());
+	String line;
+	while (std::getline (input, line))
+	{
+		size_t end = line.find_last_not_of (" \t\r");
+		if (end != String::npos)
+			files.push_back (line.substr (0, end + 1));
+	}
+	return !files.empty ();
+}
+
+// Finds the numbered frames of an animation stored as loose files by listing
+// their directory. Frames in resource archives can only be found by probing.
+static bool
+scan_frame_directory (const String& base, const char* fname, const char* ext,
+	std::vector<String>& files)
+{
+	String first = Engine::find_file_in_path ("resname_base",
+		base + "_1" + ext);
+	if (first.empty ()) return false;
+
+	String pattern = first.substr (0, first.find_last_of ("\\/") + 1)
+		+ fname + "_*" + ext;
+	WIN32_FIND_DATAA found;
+	HANDLE search = ::FindFirstFileA (pattern.data (), &found);
+	if (search == INVALID_HANDLE_VALUE) return false;
+
+	CIString prefix = CIString (fname) + "_", suffix = ext;
+	std::set<unsigned long> numbers;
+	do
+	{
+		CIString name = found.cFileName;
+		if (name.size () <= prefix.size () + suffix.size () ||
+		    name.compare (0, prefix.size (), prefix) != 0 ||
+		    name.compare (name.size () - suffix.size (), String::npos,
+				suffix) != 0)
+			continue;
+		CIString number = name.substr (prefix.size (),
+			name.size () - prefix.size () - suffix.size ());
+		if (number.find_first_not_of ("0123456789") == CIString::npos)
+			numbers.insert (std::strtoul (number.data (), nullptr,
+				10));
+	}
+	while (::FindNextFileA (search, &found));
+	::FindClose (search);
+
+	// As when probing, the frames end at the first missing number.
+	for (unsigned long frame = 1; numbers.count (frame) &&
+	     frame < MAX_BITMAP_HANDLE; ++frame)
+		files.push_back (fname + ('_' + std::to_string (frame)) + ext);
+	return !files.empty ();
 }
 
 HUDBitmap::HUDBitmap (const String& _path, bool animation)
-	: path (_path)
+	: path (_path), last_used (0ul)
 {
-	SService<IDarkOverlaySrv> DOS (LG);
+	IDarkOverlaySrv* DOS = cached_service<IDarkOverlaySrv> ();
 
 	char dir[_MAX_DIR], fname[_MAX_FNAME], ext[_MAX_EXT];
 	_splitpath (path.data (), nullptr, dir, fname, ext);
+	String base = String (dir) + fname;
+	directory = dir;
 
-	Frame max_frames = animation ? MAX_BITMAP_HANDLE : 1;
-	for (Frame frame = STATIC; frame < max_frames; ++frame)
+	std::vector<String> files;
+	if (animation && read_frame_manifest (base, files))
 	{
-		String file = fname;
-		if (frame != STATIC)
+		for (auto& file : files)
 		{
-			file += '_';
-			file += std::to_string (frame);
+			if (frames.size () == MAX_BITMAP_HANDLE) break;
+			Handle handle = DOS->GetBitmap (file.data (), dir);
+			if (handle == INVALID_HANDLE) break;
+			frames.push_back (handle);
+			frame_files.push_back (file);
 		}
-		file += ext;
-
-		Handle handle = DOS->GetBitmap (file.data (), dir);
+	}
+	else if (animation && scan_frame_directory (base, fname, ext, files))
+	{
+		// Try _1 and later even if plain is missing.
+		String plain = fname + String (ext);
+		Handle handle = DOS->GetBitmap (plain.data (), dir);
 		if (handle != INVALID_HANDLE)
+		{
 			frames.push_back (handle);
-		else if (frame != STATIC) // Try _1 even if plain is missing.
-			break;
+			frame_files.push_back (plain);
+		}
+		for (auto& file : files)
+		{
+			handle = DOS->GetBitmap (file.data (), dir);
+			if (handle == INVALID_HANDLE) break;
+			frames.push_back (handle);
+			frame_files.push_back (file);
+		}
+	}
+	else
+	{
+		Frame max_frames = animation ? MAX_BITMAP_HANDLE : 1;
+		for (Frame frame = STATIC; frame < max_frames; ++frame)
+		{
+			String file = fname;
+			if (frame != STATIC)
+			{
+				file += '_';
+				file += std::to_string (frame);
+			}
+			file += ext;
+
+			Handle handle = DOS->GetBitmap (file.data (), dir);
+			if (handle != INVALID_HANDLE)
+			{
+				frames.push_back (handle);
+				frame_files.push_back (file);
+			}
+			else if (frame != STATIC) // Try _1 even if plain is missing.
+				break;
+		}
 	}
 
 	if (frames.empty ())
 		throw MissingResource (MissingResource::BITMAP, _path,
 			Object::NONE);
+
+	DOS->GetBitmapSize (frames.front (), size.w, size.h);
 }
 
 HUDBitmap::~HUDBitmap ()
 {
-	SService<IDarkOverlaySrv> DOS (LG);
+	IDarkOverlaySrv* DOS = cached_service<IDarkOverlaySrv> ();
 	for (auto frame : frames)
 		DOS->FlushBitmap (frame);
 }
 
+bool
+HUDBitmap::revalidate ()
+{
+	IDarkOverlaySrv* DOS = cached_service<IDarkOverlaySrv> ();
+	for (size_t frame = 0u; frame < frames.size (); ++frame)
+	{
+		CanvasSize frame_size;
+		DOS->GetBitmapSize (frames [frame], frame_size.w, frame_size.h);
+		if (frame_size.w > 0 && frame_size.h > 0)
+			continue;
+
+		// The engine discarded this frame, so fetch it again. If that
+		// fails, the animation ends before it.
+		frames [frame] = DOS->GetBitmap (frame_files [frame].data (),
+			directory.data ());
+		if (frames [frame] == INVALID_HANDLE)
+		{
+			for (size_t later = frame + 1u; later < frames.size ();
+			     ++later)
+			{
+				DOS->GetBitmapSize (frames [later], frame_size.w,
+					frame_size.h);
+				if (frame_size.w > 0 && frame_size.h > 0)
+					DOS->FlushBitmap (frames [later]);
+			}
+			frames.resize (frame);
+			frame_files.resize (frame);
+			break;
+		}
+	}
+
+	if (frames.empty ())
+		return false;
+	DOS->GetBitmapSize (frames.front (), size.w, size.h);
+	return true;
+}
+
 CanvasSize
 HUDBitmap::get_size () const
 {
-	CanvasSize size;
-	SService<IDarkOverlaySrv> (LG)->GetBitmapSize
-		(frames.front (), size.w, size.h);
 	return size;
 }
 
@@ -204,15 +379,16 @@ HUDBitmap::count_frames () const
 void
 HUDBitmap::draw (Frame frame, CanvasPoint position, CanvasRect clip) const
 {
-	SService<IDarkOverlaySrv> DOS (LG);
+	last_used = HUDFrameContext::get ().number;
+	IDarkOverlaySrv* DOS = cached_service<IDarkOverlaySrv> ();
 	if (clip == CanvasRect::NOCLIP)
 		DOS->DrawBitmap (frames.at (frame), position.x, position.y);
 	else
 	{
-		CanvasSize size;
-		DOS->GetBitmapSize (frames.front (), size.w, size.h);
-		if (clip.w == CanvasRect::NOCLIP.w) clip.w = size.w - clip.x;
-		if (clip.h == CanvasRect::NOCLIP.h) clip.h = size.h - clip.y;
+		if (clip.w == CanvasRect::NOCLIP.w)
+			clip.w = size.w - clip.x;
+		if (clip.h == CanvasRect::NOCLIP.h)
+			clip.h = size.h - clip.y;
 		DOS->DrawSubBitmap (frames.at (frame), position.x, position.y,
 			clip.x, clip.y, clip.w, clip.h);
 	}
@@ -220,19 +396,192 @@ HUDBitmap::draw (Frame frame, CanvasPoint position, CanvasRect clip) const
 
 
 
+// HUDSpriteSheet
+
+HUDSpriteSheet::HUDSpriteSheet (const HUDBitmap::Ptr& _bitmap)
+	: bitmap (_bitmap)
+{
+	if (!bitmap)
+		throw MissingResource (MissingResource::BITMAP, "(null)",
+			Object::NONE);
+}
+
+HUDSpriteSheet::HUDSpriteSheet (const HUDBitmap::Ptr& _bitmap,
+		CanvasSize cell_size)
+	: HUDSpriteSheet (_bitmap)
+{
+	if (cell_size.w <= 0 || cell_size.h <= 0)
+		throw std::invalid_argument ("bad sprite cell size");
+
+	CanvasSize size = bitmap->get_size ();
+	for (int y = 0; y + cell_size.h <= size.h; y += cell_size.h)
+		for (int x = 0; x + cell_size.w <= size.w; x += cell_size.w)
+			sprites.emplace_back (x, y, cell_size.w, cell_size.h);
+}
+
+HUDSpriteSheet::Sprite
+HUDSpriteSheet::add_sprite (const CanvasRect& area)
+{
+	sprites.push_back (area);
+	return sprites.size () - 1u;
+}
+
+
+
+// TextLayout
+
+TextLayout::TextLayout (const String& _text, int _width, Alignment _alignment)
+	: text (_text), width (_width), alignment (_alignment),
+	  laid_out (false), generation (0ul)
+{}
+
+void
+TextLayout::set_text (const String& _text)
+{
+	if (text == _text) return;
+	text = _text;
+	laid_out = false;
+}
+
+void
+TextLayout::set_width (int _width)
+{
+	if (width == _width) return;
+	width = _width;
+	laid_out = false;
+}
+
+void
+TextLayout::set_alignment (Alignment _alignment)
+{
+	if (alignment == _alignment) return;
+	alignment = _alignment;
+	laid_out = false;
+}
+
+void
+TextLayout::update () const
+{
+	IOSLService* OSL = cached_service<IOSLService> ();
+	unsigned long current = OSL->get_text_generation ();
+	if (laid_out && generation == current) return;
+
+	lines.clear ();
+	size = CanvasSize ();
+	int blank_height = OSL->measure_text (" ").h;
+
+	size_t start = 0;
+	do
+	{
+		size_t end = text.find ('\n', start);
+		String paragraph = text.substr (start,
+			(end == String::npos) ? String::npos : end - start);
+		start = (end == String::npos) ? String::npos : end + 1;
+
+		if (width <= 0 || paragraph.empty ())
+		{
+			add_line (paragraph, paragraph.empty () ? CanvasSize ()
+				: OSL->measure_text (paragraph), blank_height);
+			continue;
+		}
+
+		// Add words to the line until the next one would not fit.
+		String line;
+		CanvasSize line_size;
+		for (size_t word_start = 0; word_start != String::npos;)
+		{
+			size_t word_end = paragraph.find (' ', word_start);
+			String word = paragraph.substr (word_start,
+				(word_end == String::npos) ? String::npos
+					: word_end - word_start);
+			word_start = (word_end == String::npos)
+				? String::npos : word_end + 1;
+
+			String candidate = line.empty () ? word
+				: line + ' ' + word;
+			CanvasSize candidate_size =
+				OSL->measure_text (candidate);
+
+			if (!line.empty () && candidate_size.w > width)
+			{
+				add_line (line, line_size, blank_height);
+				line = word;
+				line_size = OSL->measure_text (word);
+			}
+			else
+			{
+				line = candidate;
+				line_size = candidate_size;
+			}
+		}
+		add_line (line, line_size, blank_height);
+	}
+	while (start != String::npos);
+
+	if (width > 0) size.w = width;
+	for (auto& line : lines)
+		switch (alignment)
+		{
+		case Alignment::LEFT:
+			line.position.x = 0;
+			break;
+		case Alignment::CENTER:
+			line.position.x = (size.w - line.width) / 2;
+			break;
+		case Alignment::RIGHT:
+			line.position.x = size.w - line.width;
+			break;
+		}
+
+	laid_out = true;
+	generation = current;
+}
+
+void
+TextLayout::add_line (const String& line, CanvasSize line_size,
+	int blank_height) const
+{
+	lines.push_back ({ line, CanvasPoint (0, size.h), line_size.w });
+	size.w = std::max (size.w, line_size.w);
+	size.h += line.empty () ? blank_height : line_size.h;
+}
+
+
+
 // HUDElementBase
 
 void
 HUDElementBase::initialize (ZIndex priority)
 {
-	if (!SService<IOSLService> (LG)->register_hud_element (*this, priority))
+	if (!cached_service<IOSLService> ()->register_hud_element (*this,
+		priority))
 		throw std::runtime_error ("could not register HUD element");
 }
 
 bool
 HUDElementBase::deinitialize ()
 {
-	return SService<IOSLService> (LG)->unregister_hud_element (*this);
+	return cached_service<IOSLService> ()->unregister_hud_element (*this);
+}
+
+bool
+HUDElementBase::set_priority (ZIndex priority)
+{
+	return cached_service<IOSLService> ()->set_hud_element_priority
+		(*this, priority);
+}
+
+bool
+HUDElementBase::set_frame_budget (unsigned long budget)
+{
+	return cached_service<IOSLService> ()->set_hud_element_budget (*this,
+		budget);
+}
+
+const std::vector<HUDElementStats>&
+HUDElementBase::get_stats ()
+{
+	return cached_service<IOSLService> ()->get_hud_stats ();
 }
 
 
@@ -253,7 +602,8 @@ HUDElement::HUDElement ()
 	: initialized (false), should_draw (false), needs_redraw (true),
 	  drawing (false), overlay (INVALID_HANDLE), opacity (1.0f),
 	  _position (0, 0), _size (1, 1), scale (1.0f),
-	  drawing_color (0xFFFFFFu), drawing_offset ()
+	  drawing_color (0xFFFFFFu), drawing_offset (),
+	  retained (false), recording (false), frame_budget (0ul)
 {}
 
 HUDElement::~HUDElement ()
@@ -269,6 +619,8 @@ HUDElement::initialize (ZIndex priority)
 	else // Register the element with the handler.
 	{
 		HUDElementBase::initialize (priority);
+		if (frame_budget > 0ul)
+			HUDElementBase::set_frame_budget (frame_budget);
 		return initialized = true;
 	}
 }
@@ -304,7 +656,7 @@ HUDElement::create_overlay ()
 {
 	if (is_overlay ()) return true;
 
-	overlay = SService<IDarkOverlaySrv> (LG)->CreateTOverlayItem
+	overlay = cached_service<IDarkOverlaySrv> ()->CreateTOverlayItem
 		(_position.x, _position.y, _size.w, _size.h, 255, true);
 
 	if (is_overlay ())
@@ -327,7 +679,8 @@ HUDElement::destroy_overlay ()
 {
 	if (is_overlay ())
 	{
-		SService<IDarkOverlaySrv> (LG)->DestroyTOverlayItem (overlay);
+		cached_service<IDarkOverlaySrv> ()->DestroyTOverlayItem
+			(overlay);
 		overlay = INVALID_HANDLE;
 		schedule_redraw ();
 	}
@@ -340,7 +693,7 @@ HUDElement::set_opacity (float _opacity)
 {
 	opacity = _opacity;
 	CHECK_OVERLAY ();
-	SService<IDarkOverlaySrv> (LG)->UpdateTOverlayAlpha
+	cached_service<IDarkOverlaySrv> ()->UpdateTOverlayAlpha
 		(overlay, std::min (255, std::max (0, int (opacity * 255.0f))));
 }
 
@@ -353,7 +706,7 @@ HUDElement::set_position (CanvasPoint position)
 	_position = position;
 	if (is_overlay ())
 	{
-		SService<IDarkOverlaySrv> (LG)->UpdateTOverlayPosition
+		cached_service<IDarkOverlaySrv> ()->UpdateTOverlayPosition
 			(overlay, _position.x, _position.y);
 	}
 	else
@@ -377,7 +730,9 @@ HUDElement::set_size (CanvasSize size)
 	}
 #endif // THIEF_USE_BROKEN_HUD_OVERLAY
 
-	// For non-overlay elements, size is ignored.
+	// For non-overlay elements, size is ignored except for NOCLIP areas.
+	if (!is_overlay ())
+		schedule_redraw ();
 }
 
 #ifdef THIEF_USE_BROKEN_HUD_OVERLAY
@@ -387,19 +742,77 @@ HUDElement::set_scale (float _scale)
 {
 	scale = _scale;
 	CHECK_OVERLAY ();
-	SService<IDarkOverlaySrv> (LG)->UpdateTOverlaySize
+	cached_service<IDarkOverlaySrv> ()->UpdateTOverlaySize
 		(overlay, _size.w * scale, _size.h * scale);
 }
 
 #endif // THIEF_USE_BROKEN_HUD_OVERLAY
 
+void
+HUDElement::set_retained (bool _retained)
+{
+	if (retained == _retained) return;
+	retained = _retained;
+	display_list.clear ();
+	schedule_redraw ();
+}
+
+void
+HUDElement::set_frame_budget (unsigned long budget)
+{
+	if (frame_budget == budget) return;
+	frame_budget = budget;
+	if (initialized)
+		HUDElementBase::set_frame_budget (frame_budget);
+	schedule_redraw (); // Make sure there is a recording to replay.
+}
+
+// The drawing primitives, shared by direct drawing and display list replay.
+
+static void
+execute_color (const Color& color)
+{
+	cached_service<IDarkOverlaySrv> ()->SetTextColor (color.red,
+		color.green, color.blue);
+}
+
+static void
+execute_fill (const CanvasRect& area)
+{
+	// The overlay service has no fill, so draw along the longer side to
+	// make fewer calls. Both ways cover the same pixels: rows y to y+h-1,
+	// each from column x to x+w inclusive.
+	IDarkOverlaySrv* DOS = cached_service<IDarkOverlaySrv> ();
+	if (area.w < area.h)
+		for (int x = area.x; x <= area.x + area.w; ++x)
+			DOS->DrawLine (x, area.y, x, area.y + area.h - 1);
+	else
+		for (int y = area.y; y < area.y + area.h; ++y)
+			DOS->DrawLine (area.x, y, area.x + area.w, y);
+}
+
+static void
+execute_line (CanvasPoint from, CanvasPoint to)
+{
+	cached_service<IDarkOverlaySrv> ()->DrawLine (from.x, from.y,
+		to.x, to.y);
+}
+
+static void
+execute_text (const String& text, CanvasPoint position)
+{
+	cached_service<IDarkOverlaySrv> ()->DrawString (text.data (),
+		position.x, position.y);
+}
+
 void
 HUDElement::set_drawing_color (const Color& color)
 {
 	drawing_color = color;
 	CHECK_DRAWING ();
-	SService<IDarkOverlaySrv> (LG)->SetTextColor
-		(drawing_color.red, drawing_color.green, drawing_color.blue);
+	if (DrawCommand* command = record (DrawCommand::COLOR))
+		command->color = drawing_color;
+	execute_color (drawing_color);
 }
 
 void
@@ -423,7 +836,7 @@ HUDElement::fill_overlay (int color_index, float _opacity)
 {
 	CHECK_OVERLAY ();
 	CHECK_DRAWING ();
-	SService<IDarkOverlaySrv> (LG)->FillTOverlay (color_index,
+	cached_service<IDarkOverlaySrv> ()->FillTOverlay (color_index,
 		std::min (255, std::max (0, int (_opacity * 255.0f))));
 }
 
@@ -434,23 +847,22 @@ HUDElement::fill_area (CanvasRect area)
 {
 	CHECK_DRAWING ();
 	do_offset (area);
-	SService<IDarkOverlaySrv> DOS (LG);
-	for (int y = area.y; y < area.y + area.h; ++y)
-		DOS->DrawLine (area.x, y, area.x + area.w, y);
+	if (DrawCommand* command = record (DrawCommand::FILL))
+		command->area = area;
+	execute_fill (area);
 }
 
 void
 HUDElement::draw_box (CanvasRect area)
 {
 	CHECK_DRAWING ();
-	do_offset (area);
-	SService<IDarkOverlaySrv> DOS (LG);
-	DOS->DrawLine (area.x, area.y, area.x + area.w, area.y);
-	DOS->DrawLine (area.x, area.y, area.x, area.y + area.h);
-	DOS->DrawLine (area.x + area.w, area.y,
-		area.x + area.w, area.y + area.h);
-	DOS->DrawLine (area.x, area.y + area.h,
-		area.x + area.w, area.y + area.h);
+	// Each line is offset by draw_line.
+	draw_line ({ area.x, area.y }, { area.x + area.w, area.y });
+	draw_line ({ area.x, area.y }, { area.x, area.y + area.h });
+	draw_line ({ area.x + area.w, area.y },
+		{ area.x + area.w, area.y + area.h });
+	draw_line ({ area.x, area.y + area.h },
+		{ area.x + area.w, area.y + area.h });
 }
 
 void
@@ -459,7 +871,12 @@ HUDElement::draw_line (CanvasPoint from, CanvasPoint to)
 	CHECK_DRAWING ();
 	do_offset (from);
 	do_offset (to);
-	SService<IDarkOverlaySrv> (LG)->DrawLine (from.x, from.y, to.x, to.y);
+	if (DrawCommand* command = record (DrawCommand::LINE))
+	{
+		command->from = from;
+		command->to = to;
+	}
+	execute_line (from, to);
 }
 
 void
@@ -467,8 +884,22 @@ HUDElement::draw_text (const String& text, CanvasPoint position)
 {
 	CHECK_DRAWING ();
 	do_offset (position);
-	SService<IDarkOverlaySrv> (LG)->DrawString
-		(text.data (), position.x, position.y);
+	if (DrawCommand* command = record (DrawCommand::TEXT))
+	{
+		command->from = position;
+		command->text = text; // only copied if it will be replayed
+	}
+	execute_text (text, position);
+}
+
+void
+HUDElement::draw_text (const TextLayout& layout, CanvasPoint position)
+{
+	CHECK_DRAWING ();
+	layout.update ();
+	for (auto& line : layout.lines)
+		if (!line.text.empty ())
+			draw_text (line.text, position + line.position);
 }
 
 void
@@ -480,17 +911,66 @@ HUDElement::draw_bitmap (const HUDBitmap::Ptr& bitmap, HUDBitmap::Frame frame,
 		throw MissingResource (MissingResource::BITMAP, "(null)",
 			Object::NONE);
 	do_offset (position);
+	if (DrawCommand* command = record (DrawCommand::BITMAP))
+	{
+		command->from = position;
+		command->area = clip;
+		command->bitmap = bitmap;
+		command->frame = frame;
+	}
 	bitmap->draw (frame, position, clip);
 }
 
+void
+HUDElement::draw_sprites (const HUDSpriteSheet& sheet,
+	const std::vector<HUDSpriteSheet::Placement>& placements,
+	HUDBitmap::Frame frame)
+{
+	CHECK_DRAWING ();
+
+	// Join each sprite to the run before it if it continues that run both
+	// in the sheet and on the canvas.
+	CanvasPoint run_position;
+	CanvasRect run_area;
+	bool in_run = false;
+	for (auto& placement : placements)
+	{
+		const CanvasRect& area = sheet.get_sprite (placement.sprite);
+		if (in_run && area.y == run_area.y && area.h == run_area.h &&
+		    area.x == run_area.x + run_area.w &&
+		    placement.position.y == run_position.y &&
+		    placement.position.x == run_position.x + run_area.w)
+		{
+			run_area.w += area.w;
+			continue;
+		}
+
+		if (in_run)
+			draw_bitmap (sheet.get_bitmap (), frame, run_position,
+				run_area);
+		run_position = placement.position;
+		run_area = area;
+		in_run = true;
+	}
+
+	if (in_run)
+		draw_bitmap (sheet.get_bitmap (), frame, run_position,
+			run_area);
+}
+
 CanvasSize
 HUDElement::get_text_size (const String& text) const
 {
-	CanvasSize size;
 	CHECK_DRAWING ();
-	SService<IDarkOverlaySrv> (LG)->GetStringSize
-		(text.data (), size.w, size.h);
-	return size;
+	return cached_service<IOSLService> ()->measure_text (text);
+}
+
+CanvasSize
+HUDElement::get_text_size (const TextLayout& layout) const
+{
+	CHECK_DRAWING ();
+	layout.update ();
+	return layout.size;
 }
 
 CanvasPoint
@@ -498,7 +978,7 @@ HUDElement::location_to_canvas (const Vector& location) const
 {
 	CHECK_DRAWING ();
 	CanvasPoint position;
-	bool onscreen = SService<IDarkOverlaySrv> (LG)->WorldToScreen
+	bool onscreen = cached_service<IDarkOverlaySrv> ()->WorldToScreen
 		(LGVector (location), position.x, position.y);
 	return onscreen ? position : CanvasPoint::OFFSCREEN;
 }
@@ -508,8 +988,8 @@ HUDElement::object_to_canvas (const Object& object) const
 {
 	CHECK_DRAWING ();
 	int x1, y1, x2, y2;
-	bool onscreen = SService<IDarkOverlaySrv> (LG)->GetObjectScreenBounds
-		(object.number, x1, y1, x2, y2);
+	bool onscreen = cached_service<IDarkOverlaySrv> ()->
+		GetObjectScreenBounds (object.number, x1, y1, x2, y2);
 	return onscreen ? CanvasRect (x1, y1, x2 - x1, y2 - y1)
 		: CanvasRect::OFFSCREEN;
 }
@@ -531,6 +1011,101 @@ HUDElement::centroid_to_canvas (const Object& object) const
 	return position;
 }
 
+// Marks which of the given locations may be within the camera's field of view.
+// The test is against a cone enclosing the view frustum, moved back so that it
+// also encloses any sphere of radius margin that touches the frustum. Zoom can
+// only narrow the view, so the unzoomed field of view is used. Returns false,
+// having marked every location, if the camera is unknown.
+static bool
+cull_to_view (const std::vector<Vector>& locations, float margin,
+	std::vector<char>& visible)
+{
+	visible.assign (locations.size (), 1);
+	const HUDFrameContext& frame = HUDFrameContext::get ();
+	if (locations.empty () || !frame.camera_known) return false;
+
+	// The fov config variable is for a 4:3 canvas; wider canvases extend
+	// the view horizontally. Allow some slack beyond the corners.
+	double fov = frame.field_of_view;
+	if (fov <= 0.0 || fov >= 170.0) return false;
+	double tan_y = std::tan (fov * M_PI / 360.0),
+		tan_x = tan_y * std::max (1.0, frame.aspect_ratio * 0.75),
+		tan_corner = 1.1 * std::sqrt (tan_x * tan_x + tan_y * tan_y),
+		sec_corner = std::sqrt (1.0 + tan_corner * tan_corner);
+	float cos_squared = 1.0 / (sec_corner * sec_corner);
+
+	const Vector& camera = frame.camera_location,
+		& facing = frame.camera_rotation;
+	double heading = facing.z * M_PI / 180.0,
+		pitch = facing.y * M_PI / 180.0;
+	float fx = std::cos (pitch) * std::cos (heading),
+		fy = std::cos (pitch) * std::sin (heading),
+		fz = -std::sin (pitch),
+		setback = margin * sec_corner / tan_corner,
+		ax = camera.x - fx * setback,
+		ay = camera.y - fy * setback,
+		az = camera.z - fz * setback;
+
+	const Vector* location = locations.data ();
+	char* result = visible.data ();
+	for (size_t i = 0, count = locations.size (); i < count; ++i)
+	{
+		float dx = location [i].x - ax,
+			dy = location [i].y - ay,
+			dz = location [i].z - az,
+			along = dx * fx + dy * fy + dz * fz;
+		result [i] = along > 0.0f && along * along >=
+			(dx * dx + dy * dy + dz * dz) * cos_squared;
+	}
+	return true;
+}
+
+std::vector<CanvasPoint>
+HUDElement::project_many (const std::vector<Vector>& locations) const
+{
+	CHECK_DRAWING ();
+	std::vector<char> visible;
+	cull_to_view (locations, 0.0f, visible);
+
+	std::vector<CanvasPoint> positions (locations.size (),
+		CanvasPoint::OFFSCREEN);
+	for (size_t i = 0; i < locations.size (); ++i)
+		if (visible [i])
+			positions [i] = location_to_canvas (locations [i]);
+	return positions;
+}
+
+std::vector<CanvasPoint>
+HUDElement::project_many (const Object::List& objects, float margin) const
+{
+	CHECK_DRAWING ();
+	std::vector<Vector> centroids;
+	centroids.reserve (objects.size ());
+	for (auto& object : objects)
+		centroids.push_back (object.get_location ());
+
+	std::vector<char> visible;
+	cull_to_view (centroids, margin, visible);
+
+	std::vector<CanvasPoint> positions (objects.size (),
+		CanvasPoint::OFFSCREEN);
+	for (size_t i = 0; i < objects.size (); ++i)
+	{
+		if (!visible [i]) continue;
+		positions [i] = location_to_canvas (centroids [i]);
+		if (!positions [i].valid ()) // As in centroid_to_canvas.
+		{
+			CanvasRect bounds = object_to_canvas (objects [i]);
+			if (bounds.valid ())
+			{
+				positions [i].x = bounds.x + bounds.w / 2;
+				positions [i].y = bounds.y + bounds.h / 2;
+			}
+		}
+	}
+	return positions;
+}
+
 bool
 HUDElement::prepare ()
 {
@@ -552,21 +1127,87 @@ HUDElement::do_offset (CanvasRect& area) const
 	if (area.h == CanvasRect::NOCLIP.h) area.h = _size.h;
 }
 
+HUDElement::DrawCommand*
+HUDElement::record (DrawCommand::Type type)
+{
+	if (!recording) return nullptr;
+	display_list.emplace_back ();
+	display_list.back ().type = type;
+	return &display_list.back ();
+}
+
+void
+HUDElement::execute (const DrawCommand& command) const
+{
+	switch (command.type)
+	{
+	case DrawCommand::COLOR:
+		execute_color (command.color);
+		break;
+	case DrawCommand::FILL:
+		execute_fill (command.area);
+		break;
+	case DrawCommand::LINE:
+		execute_line (command.from, command.to);
+		break;
+	case DrawCommand::TEXT:
+		execute_text (command.text, command.from);
+		break;
+	case DrawCommand::BITMAP:
+		command.bitmap->draw (command.frame, command.from,
+			command.area);
+		break;
+	}
+}
+
 void
 HUDElement::on_event (Event event)
 {
-	SService<IDarkOverlaySrv> DOS (LG);
+	IDarkOverlaySrv* DOS = cached_service<IDarkOverlaySrv> ();
 
 	switch (event)
 	{
 
+	case Event::REPLAY_STAGE_1:
+		if (!is_overlay () && (retained || frame_budget > 0ul) &&
+		    !needs_redraw)
+		{
+			// Keep the outcome of the last prepare () as well.
+			if (!should_draw) return;
+			drawing = true;
+			for (auto& command : display_list)
+				execute (command);
+			drawing = false;
+			break;
+		}
+		// There is nothing to replay, so draw as usual.
+
 	case Event::DRAW_STAGE_1:
 		drawing = true;
 		should_draw = prepare ();
-		if (should_draw && !is_overlay ())
+		if (should_draw && !is_overlay () && retained && !needs_redraw)
+		{
+			for (auto& command : display_list)
+				execute (command);
+		}
+		else if (should_draw && !is_overlay ())
 		{
 			needs_redraw = false;
-			redraw ();
+			display_list.clear ();
+			recording = retained || frame_budget > 0ul;
+			try
+			{
+				// Replays must start from the same drawing color.
+				if (recording) set_drawing_color (drawing_color);
+				redraw ();
+			}
+			catch (...)
+			{
+				recording = drawing = false;
+				needs_redraw = true; // Don't replay a partial list.
+				throw;
+			}
+			recording = false;
 		}
 		drawing = false;
 		break;
@@ -584,6 +1225,11 @@ HUDElement::on_event (Event event)
 		DOS->DrawTOverlayItem (overlay);
 		break;
 
+	case Event::REPLAY_STAGE_2:
+		if (should_draw && is_overlay ())
+			DOS->DrawTOverlayItem (overlay);
+		break;
+
 	default:
 		break;
 	}
@@ -591,5 +1237,39 @@ HUDElement::on_event (Event event)
 
 
 
+// HUDStatsDisplay
+
+HUDStatsDisplay::HUDStatsDisplay (CanvasPoint position, ZIndex priority)
+{
+	set_position (position);
+	initialize (priority);
+}
+
+HUDStatsDisplay::~HUDStatsDisplay ()
+{}
+
+void
+HUDStatsDisplay::redraw ()
+{
+	static const boost::format LINE
+		("%|-32| %|6| %|7| us %|7| us %|7| us  1/%||\n");
+
+	std::ostringstream text;
+	text << "element (z, mean, worst, budget, interval)\n";
+	for (auto& stats : get_stats ())
+		text << boost::format (LINE) % stats.type.substr (0, 32)
+			% stats.priority % stats.mean_time % stats.worst_time
+			% stats.budget % stats.interval;
+
+	TextLayout layout (text.str ());
+	CanvasSize size = get_text_size (layout);
+	set_drawing_color (Color (0, 0, 0));
+	fill_area (CanvasRect (-2, -2, size.w + 4, size.h + 4));
+	set_drawing_color (Color (255, 255, 255));
+	draw_text (layout);
+}
+
+
+
 } // namespace Thief
 
@@ -34,7 +34,8 @@ const Flavor
 Flavor::ANY = 0;
 
 Flavor::Flavor (const String& name)
-	: number (SService<ILinkToolsSrv> (LG)->LinkKindNamed (name.data ()))
+	: number (cached_service<ILinkToolsSrv> ()->LinkKindNamed
+		(name.data ()))
 {
 	if (*this == ANY)
 		throw MissingResource (MissingResource::FLAVOR, name,
@@ -46,7 +47,7 @@ Flavor::Flavor (const char* name)
 {
 	if (name)
 	{
-		number = SService<ILinkToolsSrv> (LG)->LinkKindNamed (name);
+		number = cached_service<ILinkToolsSrv> ()->LinkKindNamed (name);
 		if (*this == ANY)
 			throw MissingResource (MissingResource::FLAVOR, name,
 				Object::NONE);
@@ -57,7 +58,7 @@ String
 Flavor::get_name () const
 {
 	LGString name;
-	SService<ILinkToolsSrv> (LG)->LinkKindName (name, number);
+	cached_service<ILinkToolsSrv> ()->LinkKindName (name, number);
 	return name;
 }
 
@@ -80,11 +81,11 @@ Link::create (Flavor flavor, const Object& source, const Object& dest,
 	const void* data)
 {
 	if (data)
-		return Link (SInterface<ILinkManager> (LG)->AddFull
+		return Link (cached_interface<ILinkManager> ()->AddFull
 			(source.number, dest.number, flavor.number,
 				const_cast<void*> (data)));
 	else
-		return Link (SInterface<ILinkManager> (LG)->Add
+		return Link (cached_interface<ILinkManager> ()->Add
 			(source.number, dest.number, flavor.number));
 }
 
@@ -92,20 +93,20 @@ bool
 Link::exists () const
 {
 	sLink info;
-	return SInterface<ILinkManager> (LG)->Get (number, &info);
+	return cached_interface<ILinkManager> ()->Get (number, &info);
 }
 
 bool
 Link::destroy ()
 {
-	return SInterface<ILinkManager> (LG)->Remove (number) == S_OK;
+	return cached_interface<ILinkManager> ()->Remove (number) == S_OK;
 }
 
 Object
 Link::get_source () const
 {
 	sLink info;
-	return SInterface<ILinkManager> (LG)->Get (number, &info)
+	return cached_interface<ILinkManager> ()->Get (number, &info)
 		? Object (info.source) : Object::NONE;
 }
 
@@ -113,14 +114,14 @@ Object
 Link::get_dest () const
 {
 	sLink info;
-	return SInterface<ILinkManager> (LG)->Get (number, &info)
+	return cached_interface<ILinkManager> ()->Get (number, &info)
 		? Object (info.dest) : Object::NONE;
 }
 
 const void*
 Link::get_data_raw () const
 {
-	return exists () ? SInterface<ILinkManager> (LG)->GetData (number)
+	return exists () ? cached_interface<ILinkManager> ()->GetData (number)
 		: nullptr;
 }
 
@@ -130,7 +131,7 @@ Link::set_data_raw (const void* data)
 	if (!exists ())
 		throw MissingResource (MissingResource::LINK,
 			std::to_string (number), Object::NONE);
-	SInterface<ILinkManager> (LG)->SetData
+	cached_interface<ILinkManager> ()->SetData
 		(number, const_cast<void*> (data));
 }
 
@@ -138,7 +139,7 @@ void
 Link::_get_data_field (const char* field, LGMultiBase& multi) const
 {
 	if (exists ())
-		SService<ILinkToolsSrv> (LG)->LinkGetData
+		cached_service<ILinkToolsSrv> ()->LinkGetData
 			(multi, number, field);
 	else
 		multi.clear ();
@@ -150,7 +151,7 @@ Link::_set_data_field (const char* field, const LGMultiBase& multi)
 	if (!exists ())
 		throw MissingResource (MissingResource::LINK,
 			std::to_string (number), Object::NONE);
-	SService<ILinkToolsSrv> (LG)->LinkSetData
+	cached_service<ILinkToolsSrv> ()->LinkSetData
 		(number, field, multi);
 }
 
@@ -161,7 +162,7 @@ Link::_set_data_field (const char* field, const LGMultiBase& multi)
 bool
 Link::any_exist (Flavor flavor, const Object& source, const Object& dest)
 {
-	return SInterface<ILinkManager> (LG)->AnyLinks
+	return cached_interface<ILinkManager> ()->AnyLinks
 		(flavor.number, source.number, dest.number);
 }
 
@@ -204,7 +205,7 @@ Link::List
 Link::get_all (Flavor flavor, const Object& source, const Object& dest,
 	Inheritance inheritance)
 {
-	SInterface<ILinkManager> LM (LG);
+	ILinkManager* LM = cached_interface<ILinkManager> ();
 	std::vector<ILinkQuery*> queries;
 	List links;
 
@@ -271,14 +272,15 @@ Link::dump_links (Flavor flavor, const Object& source, const Object& dest,
 void
 Link::subscribe (Flavor flavor, const Object& source, const Object& host)
 {
-	if (!SService<IOSLService> (LG)->subscribe_links (flavor, source, host))
+	if (!cached_service<IOSLService> ()->subscribe_links (flavor, source,
+		host))
 		throw std::runtime_error ("could not subscribe to links");
 }
 
 bool
 Link::unsubscribe (Flavor flavor, const Object& source, const Object& host)
 {
-	return SService<IOSLService> (LG)->unsubscribe_links
+	return cached_service<IOSLService> ()->unsubscribe_links
 		(flavor, source, host);
 }
 
@@ -37,7 +37,8 @@ Timer::cancel ()
 {
 	if (id)
 	{
-		LG->KillTimedMessage (tScrTimer (id));
+		if (!cached_service<IOSLService> ()->cancel_timer (*this))
+			LG->KillTimedMessage (tScrTimer (id));
 		id = nullptr;
 	}
 }
@@ -123,18 +124,44 @@ Message::post (const Object& from, const Object& to)
 Timer
 Message::schedule (const Object& from, const Object& to,
 	Time delay, bool repeating)
+{
+	return _schedule (from, to, delay, repeating, Object::NONE, 0ul);
+}
+
+Timer
+Message::_schedule (const Object& from, const Object& to, Time delay,
+	bool repeating, const Object& host, Time now)
 {
 	if (!is_postable ())
 		throw std::logic_error ("This message type cannot be scheduled.");
 	message->from = from.number;
 	message->to = to.number;
+
+	// Timer messages are multiplexed onto the OSL's timer wheel if it can
+	// take them; anything else gets an engine timer of its own.
+	if (_stricmp (message->message, "Timer") == 0)
+	{
+		Timer timer = cached_service<IOSLService> ()->start_timer
+			(message, delay, repeating, host, now);
+		if (timer) return timer;
+	}
+
 	return Timer (LG->SetTimedMessage (message, delay,
 		repeating ? kSTM_Periodic : kSTM_OneShot));
 }
 
 void
-Message::broadcast (const Link::List& links, Time delay)
+Message::broadcast (const Link::List& links, Time delay, bool queued)
 {
+	// Only a message with no fields beyond the generic ones can be copied
+	// into the queue; any other is sent directly.
+	if (queued && delay == 0ul && is_generic ())
+	{
+		cached_service<IOSLService> ()->queue_broadcast (message,
+			links);
+		return;
+	}
+
 	for (auto& link : links)
 		if (delay > 0ul)
 			schedule (link.get_source (), link.get_dest (),
@@ -144,9 +171,10 @@ Message::broadcast (const Link::List& links, Time delay)
 }
 
 void
-Message::broadcast (const Object& from, const Flavor& link_flavor, Time delay)
+Message::broadcast (const Object& from, const Flavor& link_flavor, Time delay,
+	bool queued)
 {
-	broadcast (Link::get_all (link_flavor, from), delay);
+	broadcast (Link::get_all (link_flavor, from), delay, queued);
 }
 
 bool
@@ -164,17 +192,20 @@ Message::has_data (Slot slot) const
 	}
 }
 
-void
-Message::_get_data (Slot slot, LGMultiBase& value) const
+const LGMultiBase&
+Message::_get_data (Slot slot) const
 {
+	// The engine's sMultiParm is read in place instead of being copied.
+	static const LGMulti<Empty> none;
 	switch (slot)
 	{
-	case DATA1: value = message->data; break;
-	case DATA2: value = message->data2; break;
-	case DATA3: value = message->data3; break;
-	case REPLY: value = reply_remote
-		? *reply_remote : (const sMultiParm&) reply_local; break;
-	default: value.clear ();
+	case DATA1: return LGMultiBase::view (message->data);
+	case DATA2: return LGMultiBase::view (message->data2);
+	case DATA3: return LGMultiBase::view (message->data3);
+	case REPLY: return reply_remote
+		? LGMultiBase::view (*reply_remote)
+		: reply_local;
+	default: return none;
 	}
 }
 
@@ -188,8 +219,7 @@ Message::_set_data (Slot slot, const LGMultiBase& value)
 	case DATA3: message->data3 = value; break;
 	case REPLY:
 		if (reply_remote)
-			*reinterpret_cast<LGMultiBase*> (reply_remote) =
-				(const sMultiParm&) value;
+			LGMultiBase::view (*reply_remote) = (const sMultiParm&) value;
 		else
 			reply_local = (const sMultiParm&) value;
 		break;
@@ -203,6 +233,12 @@ Message::is_postable () const
 	return true;
 }
 
+bool
+Message::is_generic () const
+{
+	return false;
+}
+
 
 
 // MessageWrapError
@@ -229,15 +265,22 @@ MessageWrapError::what () const noexcept
 
 // GenericMessage
 
-MESSAGE_WRAPPER_IMPL_ (GenericMessage, true) // allow any message type
+MESSAGE_WRAPPER_IMPL_ (GenericMessage, true), // allow any message type
+	created (false)
 {}
 
 GenericMessage::GenericMessage (const char* name)
-	: Message (new sGenericScrMsg ())
+	: Message (new PooledMessage<sGenericScrMsg> ()), created (true)
 {
 	message->message = name;
 }
 
+bool
+GenericMessage::is_generic () const
+{
+	return created;
+}
+
 
 
 // TimerMessage
@@ -247,7 +290,7 @@ MESSAGE_WRAPPER_IMPL (TimerMessage, "Timer"),
 {}
 
 TimerMessage::TimerMessage (const String& _timer_name)
-	: Message (new sScrTimerMsg ()), timer_name (_timer_name)
+	: Message (new PooledMessage<sScrTimerMsg> ()), timer_name (_timer_name)
 {
 	message->message = "Timer";
 	MESSAGE_AS (sScrTimerMsg)->name = timer_name.data ();
@@ -270,7 +313,8 @@ MESSAGE_WRAPPER_IMPL_ (LinkMessage,
 
 LinkMessage::LinkMessage (Event _event, Flavor _flavor, Link::Number _link,
 		const Object& _source, const Object& _dest)
-	: Message (new LinkMessageImpl ()), event (_event), flavor (_flavor),
+	: Message (new PooledMessage<LinkMessageImpl> ()),
+	  event (_event), flavor (_flavor),
 	  link (_link), source (_source), dest (_dest)
 {
 	switch (event)
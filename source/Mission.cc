@@ -49,7 +49,7 @@ MESSAGE_WRAPPER_IMPL (DifficultyMessage, "Difficulty"),
 {}
 
 DifficultyMessage::DifficultyMessage (Difficulty _difficulty)
-	: Message (new sDiffScrMsg ()), difficulty (_difficulty)
+	: Message (new PooledMessage<sDiffScrMsg> ()), difficulty (_difficulty)
 {
 	message->message = "Difficulty";
 	MESSAGE_AS (sDiffScrMsg)->difficulty = int (difficulty);
@@ -115,14 +115,14 @@ bool
 Mission::is_fm ()
 {
 	LGString junk;
-	return SService<IVersionSrv> (LG)->GetCurrentFM (junk) != S_FALSE;
+	return cached_service<IVersionSrv> ()->GetCurrentFM (junk) != S_FALSE;
 }
 
 String
 Mission::get_fm_name ()
 {
 	LGString name;
-	SService<IVersionSrv> (LG)->GetCurrentFM (name);
+	cached_service<IVersionSrv> ()->GetCurrentFM (name);
 	return name;
 }
 
@@ -130,7 +130,7 @@ String
 Mission::get_fm_path ()
 {
 	LGString name;
-	SService<IVersionSrv> (LG)->GetCurrentFMPath (name);
+	cached_service<IVersionSrv> ()->GetCurrentFMPath (name);
 	return name;
 }
 
@@ -138,7 +138,7 @@ String
 Mission::get_path_in_fm (const String& relative_path)
 {
 	LGString path;
-	SService<IVersionSrv> (LG)->FMizePath (relative_path.data (), path);
+	cached_service<IVersionSrv> ()->FMizePath (relative_path.data (), path);
 	if ((const char*) path == relative_path.data ()) path.owned = false;
 	return path;
 }
@@ -147,7 +147,7 @@ Mission::get_path_in_fm (const String& relative_path)
 int
 Mission::get_number ()
 {
-	return SService<IDarkGameSrv> (LG)->GetCurrentMission ();
+	return cached_service<IDarkGameSrv> ()->GetCurrentMission ();
 }
 #endif // IS_THIEF2
 
@@ -155,7 +155,7 @@ String
 Mission::get_mis_file ()
 {
 	LGString file;
-	SService<IVersionSrv> (LG)->GetMap (file);
+	cached_service<IVersionSrv> ()->GetMap (file);
 	return file;
 }
 
@@ -163,7 +163,7 @@ String
 Mission::get_gam_file ()
 {
 	LGString file;
-	SService<IVersionSrv> (LG)->GetGamsys (file);
+	cached_service<IVersionSrv> ()->GetGamsys (file);
 	return file;
 }
 
@@ -175,14 +175,14 @@ Mission::get_gam_file ()
 void
 Mission::set_next (int number)
 {
-	SService<IDarkGameSrv> (LG)->SetNextMission (number);
+	cached_service<IDarkGameSrv> ()->SetNextMission (number);
 }
 #endif // IS_THIEF2
 
 void
 Mission::fade_to_black (Time duration)
 {
-	SService<IDarkGameSrv> (LG)->FadeToBlack (duration / 1000.0f);
+	cached_service<IDarkGameSrv> ()->FadeToBlack (duration / 1000.0f);
 }
 
 void
@@ -194,7 +194,7 @@ Mission::end (bool win)
 			Engine::run_command ("win_mission");
 	}
 	else
-		SService<IDarkGameSrv> (LG)->EndMission ();
+		cached_service<IDarkGameSrv> ()->EndMission ();
 }
 
 void
@@ -246,7 +246,7 @@ Mission::set_envmap_texture (unsigned zone, const String& texture)
 	if (zone >= 64u)
 		throw std::out_of_range ("bad environment map zone");
 
-	SService<IEngineSrv> (LG)->SetEnvMapZone
+	cached_service<IEngineSrv> ()->SetEnvMapZone
 		(zone, texture.empty () ? nullptr : texture.data ());
 }
 
@@ -256,11 +256,11 @@ Mission::get_fog (Fog::Zone zone)
 	Fog fog; int red = 0, green = 0, blue = 0;
 
 	if (zone == Fog::GLOBAL)
-		SService<IEngineSrv> (LG)->GetFog
+		cached_service<IEngineSrv> ()->GetFog
 			(red, green, blue, fog.distance);
 
 	else if (zone > Fog::GLOBAL && zone <= Fog::_MAX_ZONE)
-		SService<IEngineSrv> (LG)->GetFogZone
+		cached_service<IEngineSrv> ()->GetFogZone
 			(zone, red, green, blue, fog.distance);
 
 	fog.color = Color (red, green, blue);
@@ -271,11 +271,11 @@ void
 Mission::set_fog (Fog::Zone zone, const Fog& fog)
 {
 	if (zone == Fog::GLOBAL)
-		SService<IEngineSrv> (LG)->SetFog (fog.color.red,
+		cached_service<IEngineSrv> ()->SetFog (fog.color.red,
 			fog.color.green, fog.color.blue, fog.distance);
 
 	else if (zone > Fog::GLOBAL && zone <= Fog::_MAX_ZONE)
-		SService<IEngineSrv> (LG)->SetFogZone (zone, fog.color.red,
+		cached_service<IEngineSrv> ()->SetFogZone (zone, fog.color.red,
 			fog.color.green, fog.color.blue, fog.distance);
 }
 
@@ -286,7 +286,7 @@ Mission::get_precipitation ()
 	int type;
 	LGString texture;
 	LGVector wind;
-	SService<IEngineSrv> (LG)->GetWeather (type, precip.frequency,
+	cached_service<IEngineSrv> ()->GetWeather (type, precip.frequency,
 		precip.speed, precip.visible_distance, precip.radius,
 		precip.opacity, precip.brightness, precip.snow_jitter,
 		precip.rain_length, precip.splash_frequency,
@@ -301,7 +301,7 @@ Mission::get_precipitation ()
 void
 Mission::set_precipitation (const Precipitation& precip)
 {
-	SService<IEngineSrv> (LG)->SetWeather (int (precip.type),
+	cached_service<IEngineSrv> ()->SetWeather (int (precip.type),
 		precip.frequency, precip.speed, precip.visible_distance,
 		precip.radius, precip.opacity, precip.brightness,
 		precip.snow_jitter, precip.rain_length, precip.splash_frequency,
@@ -336,7 +336,7 @@ Interface::get_text (const String& directory, const String& file,
 	const String& name)
 {
 	LGString result;
-	SService<IDataSrv> (LG)->GetString (result, file.data (),
+	cached_service<IDataSrv> ()->GetString (result, file.data (),
 		name.data (), "", directory.data ());
 	return result;
 }
@@ -366,7 +366,8 @@ void
 Interface::show_text (const String& text, Time duration, const Color& color)
 {
 	if (duration == 0ul) duration = calc_text_duration (text);
-	SService<IDarkUISrv> (LG)->TextMessage (text.data (), color, duration);
+	cached_service<IDarkUISrv> ()->TextMessage (text.data (), color,
+		duration);
 }
 
 
@@ -386,7 +387,8 @@ Interface::show_book (const String& book, const String& art, bool reload)
 	if (reload)
 		Engine::run_command ("test_book_ex", book + "," + art);
 	else
-		SService<IDarkUISrv> (LG)->ReadBook (book.data (), art.data ());
+		cached_service<IDarkUISrv> ()->ReadBook (book.data (),
+			art.data ());
 }
 
 bool
@@ -428,14 +430,15 @@ Interface::show_map ()
 bool
 Interface::has_visited_automap_location (int page, int location)
 {
-	return SService<IDarkGameSrv> (LG)->GetAutomapLocationVisited
+	return cached_service<IDarkGameSrv> ()->GetAutomapLocationVisited
 		(page, location);
 }
 
 void
 Interface::visit_automap_location (int page, int location)
 {
-	SService<IDarkGameSrv> (LG)->SetAutomapLocationVisited (page, location);
+	cached_service<IDarkGameSrv> ()->SetAutomapLocationVisited (page,
+		location);
 }
 
 #endif // IS_THIEF2
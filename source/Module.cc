@@ -171,6 +171,9 @@ ScriptModuleInit (const char* name, IScriptMan* manager, MPrintfProc mprintf,
 	if (!osl_init || !osl_init (manager, mprintf, allocator))
 		return false;
 
+	// Obtain the engine services used by ThiefLib.
+	Thief::ServiceCache::attach ();
+
 	// Prepare the ScriptModule.
 	Thief::module.set_name (name);
 	Thief::module.QueryInterface (IID_IScriptModule,
@@ -189,7 +192,8 @@ DllMain (HINSTANCE dll, DWORD reason, PVOID reserved)
 {
 	if (reason == DLL_PROCESS_ATTACH)
 		DisableThreadLibraryCalls (dll);
-	(void) reserved;
+	else if (reason == DLL_PROCESS_DETACH && !reserved)
+		Thief::ServiceCache::detach (); // not if the process is exiting
 	return true;
 }
 
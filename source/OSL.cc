@@ -24,6 +24,8 @@
 #include "Private.hh"
 #include "OSL.hh"
 
+#include <cxxabi.h>
+#include <typeinfo>
 #include <windef.h>
 #include <winbase.h>
 
@@ -39,10 +41,28 @@ extern "C" const GUID IID_IOSLService = THIEF_IOSLService_GUID;
 // OSL::HUDElementInfo
 
 OSL::HUDElementInfo::HUDElementInfo (HUDElementBase& _element,
-		HUDElementBase::ZIndex _priority)
+		HUDElementBase::ZIndex _priority, unsigned long _sequence)
 	: element (_element),
-	  priority (_priority)
-{}
+	  priority (_priority),
+	  sequence (_sequence),
+	  removed (false),
+	  mean_time (0.0),
+	  skipped (0u),
+	  replaying (false),
+	  stage_1_ticks (-1)
+{
+	int status = 0;
+	const char* mangled = typeid (element).name ();
+	char* demangled = abi::__cxa_demangle (mangled, nullptr, nullptr,
+		&status);
+	stats.type = (status == 0 && demangled) ? demangled : mangled;
+	std::free (demangled);
+
+	stats.priority = priority;
+	stats.draws = stats.replays = 0ul;
+	stats.mean_time = stats.worst_time = stats.budget = 0ul;
+	stats.interval = 1u;
+}
 
 bool
 OSL::HUDElementInfo::operator == (const HUDElementInfo& rhs) const
@@ -54,7 +74,7 @@ bool
 OSL::HUDElementInfo::operator < (const HUDElementInfo& rhs) const
 {
 	return priority < rhs.priority ||
-		(priority == rhs.priority && &element < &rhs.element);
+		(priority == rhs.priority && sequence < rhs.sequence);
 }
 
 
@@ -65,23 +85,49 @@ OSL*
 OSL::self = nullptr;
 
 OSL::OSL ()
-	: is_hud_handler (false)
+	: object_generation (0ul),
+	  object_listen_handle (0),
+	  is_hud_handler (false),
+	  hud_element_sequence (0ul),
+	  iterating_hud_elements (false),
+	  hud_timer_frequency (0),
+	  hud_frame_captured (false),
+	  hud_frame_drawing (false),
+	  text_generation (0ul),
+	  draining_broadcasts (false),
+	  current_broadcast (-1),
+	  job_frame (0ul),
+	  job_frame_spent (0ul)
 {
 	if (self)
 		throw std::runtime_error ("Thief::OSL already initialized.");
 	self = this;
 
+	hud_bitmap_stats.hits = hud_bitmap_stats.misses =
+		hud_bitmap_stats.evictions = 0ul;
+	hud_bitmap_stats.bitmaps = 0u;
+	hud_bitmap_stats.frames = 0u;
+	hud_bitmap_stats.limit = 64u;
+
 	static sDispatchListenerDesc sim_listener
 		{ &IID_IOSLService, 0xF, on_sim, nullptr };
-	SInterface<ISimManager> (LG)->Listen (&sim_listener);
+	cached_interface<ISimManager> ()->Listen (&sim_listener);
+
+	static sObjListenerDesc object_listener { on_object_event, nullptr };
+	object_listen_handle =
+		cached_interface<IObjectSystem> ()->Listen (&object_listener);
 }
 
 OSL::~OSL ()
 {
 	self = nullptr;
+	// Flush the retained bitmaps while the engine is still available.
+	while (!retained_hud_bitmaps.empty ())
+		evict_hud_bitmap ();
 	if (is_hud_handler)
-		SService<IDarkOverlaySrv> (LG)->SetHandler (nullptr);
-	SInterface<ISimManager> (LG)->Unlisten (&IID_IOSLService);
+		cached_service<IDarkOverlaySrv> ()->SetHandler (nullptr);
+	cached_interface<ISimManager> ()->Unlisten (&IID_IOSLService);
+	cached_interface<IObjectSystem> ()->Unlisten (object_listen_handle);
 }
 
 STDMETHODIMP_ (void)
@@ -106,6 +152,81 @@ OSL::get_param_cache ()
 	return param_cache.get ();
 }
 
+STDMETHODIMP_ (const unsigned long*)
+OSL::get_object_generation ()
+{
+	return &object_generation;
+}
+
+STDMETHODIMP_ (const String&)
+OSL::get_object_name (Object::Number number)
+{
+	// Another module or the editor may have renamed the object, so a cached
+	// name is only used while it still names the object. That check is
+	// cheaper than fetching and copying the name again.
+	auto cached = object_names.find (number);
+	if (cached != object_names.end ())
+	{
+		LGObject named;
+		cached_service<IObjectSrv> ()->Named (named,
+			cached->second.data ());
+		if (Object::Number (named) == number)
+			return cached->second;
+	}
+
+	LGString _name;
+	cached_service<IObjectSrv> ()->GetName (_name, number);
+	String name (_name);
+
+	// Unnamed objects aren't cached, since they may be named elsewhere.
+	static const String UNNAMED;
+	if (name.empty ())
+	{
+		if (cached != object_names.end ())
+			object_names.erase (cached);
+		return UNNAMED;
+	}
+
+	String& result = object_names [number];
+	result = name;
+	return result;
+}
+
+STDMETHODIMP_ (Object::Number)
+OSL::find_object (const char* name)
+{
+	// Names are not cached this way: the one call needed to check that a
+	// cached name still belongs to its object would answer the query.
+	if (!name || !*name)
+		return Object::NONE.number;
+	LGObject named;
+	cached_service<IObjectSrv> ()->Named (named, name);
+	return named;
+}
+
+STDMETHODIMP_ (void)
+OSL::forget_object_name (Object::Number number)
+{
+	object_names.erase (number);
+}
+
+void __stdcall
+OSL::on_object_event (int number, eObjNotifyMsg event, void*)
+{
+	// Any change to the object system invalidates cached existence.
+	if (!self) return;
+	++self->object_generation;
+	self->forget_object_name (number);
+
+	// A destroyed object can no longer drive the timer wheel.
+	if (event == kObjNotifyDelete)
+		try
+		{
+			self->timer_wheel.host_lost (Object (number));
+		}
+		catch (...) {}
+}
+
 int __cdecl
 OSL::on_sim (const sDispatchMsg* message, const sDispatchListenerDesc*)
 {
@@ -116,10 +237,15 @@ OSL::on_sim (const sDispatchMsg* message, const sDispatchListenerDesc*)
 	{
 
 	case kSimStart:
+		try
+		{
+			self->revalidate_hud_bitmaps ();
+		}
+		catch (...) {}
 		if (!self->hud_elements.empty ())
 			try
 			{
-				SService<IDarkOverlaySrv> (LG)->SetHandler
+				cached_service<IDarkOverlaySrv> ()->SetHandler
 					(self);
 				self->is_hud_handler = true;
 			}
@@ -127,6 +253,8 @@ OSL::on_sim (const sDispatchMsg* message, const sDispatchListenerDesc*)
 		break;
 
 	case kSimStop:
+		++self->object_generation;
+		self->object_names.clear ();
 		try
 		{
 			if (self->param_cache)
@@ -134,7 +262,20 @@ OSL::on_sim (const sDispatchMsg* message, const sDispatchListenerDesc*)
 
 			self->is_hud_handler = false; // Doesn't survive the sim.
 			self->hud_elements.clear ();
-			self->hud_bitmaps.clear ();
+			self->hud_element_index.clear ();
+			self->hud_element_changes.clear ();
+			self->hud_frame_captured = false;
+			self->preloaded_hud_bitmaps.clear ();
+
+			// Recently used bitmaps are kept for the next sim, where
+			// their handles are checked before anything is drawn.
+			for (auto iter = self->hud_bitmaps.begin ();
+			     iter != self->hud_bitmaps.end ();)
+				if (iter->second.expired ())
+					iter = self->hud_bitmaps.erase (iter);
+				else
+					++iter;
+			self->forget_text_measurements ();
 
 			self->link_subscriptions.clear ();
 			self->property_subscriptions.clear ();
@@ -143,6 +284,12 @@ OSL::on_sim (const sDispatchMsg* message, const sDispatchListenerDesc*)
 			for (auto& listen : self->listened_properties)
 				listen.first.iface->Unlisten (listen.second);
 			self->listened_properties.clear ();
+
+			self->timer_wheel.reset ();
+
+			self->jobs.clear ();
+			self->job_frame = 0ul;
+			self->job_frame_spent = 0ul;
 		}
 		catch (...) {}
 		break;
@@ -161,22 +308,116 @@ OSL::on_sim (const sDispatchMsg* message, const sDispatchListenerDesc*)
 STDMETHODIMP_ (void)
 OSL::DrawHUD ()
 {
-	for (auto& element : hud_elements)
-		element.element.on_event (HUDElementBase::Event::DRAW_STAGE_1);
+	++hud_frame.number;
+	capture_hud_frame ();
+
+	if (hud_timer_frequency == 0)
+	{
+		LARGE_INTEGER frequency;
+		hud_timer_frequency = QueryPerformanceFrequency (&frequency)
+			? frequency.QuadPart : -1;
+	}
+
+	hud_frame_drawing = iterating_hud_elements = true;
+	try
+	{
+		for (auto& element : hud_elements)
+		{
+			if (element.removed) continue;
+
+			// The time is normally recorded after stage 2.
+			if (element.stage_1_ticks >= 0)
+				record_hud_time (element, element.stage_1_ticks);
+
+			// An element over its budget is drawn in full less often.
+			element.replaying = element.stats.budget > 0ul &&
+				++element.skipped < element.stats.interval;
+			if (element.replaying)
+			{
+				element.element.on_event
+					(HUDElementBase::Event::REPLAY_STAGE_1);
+				++element.stats.replays;
+				continue;
+			}
+
+			LARGE_INTEGER start, end;
+			QueryPerformanceCounter (&start);
+			element.element.on_event
+				(HUDElementBase::Event::DRAW_STAGE_1);
+			QueryPerformanceCounter (&end);
+			element.stage_1_ticks = end.QuadPart - start.QuadPart;
+		}
+	}
+	catch (...)
+	{
+		hud_frame_drawing = false;
+		finish_hud_iteration ();
+		throw;
+	}
+	hud_frame_drawing = false;
+	finish_hud_iteration ();
 }
 
 STDMETHODIMP_ (void)
 OSL::DrawTOverlay ()
 {
-	for (auto& element : hud_elements)
-		element.element.on_event (HUDElementBase::Event::DRAW_STAGE_2);
+	// This is the second stage of the frame begun in DrawHUD.
+	hud_frame_drawing = iterating_hud_elements = true;
+	try
+	{
+		for (auto& element : hud_elements)
+		{
+			if (element.removed) continue;
+
+			if (element.replaying)
+			{
+				element.element.on_event
+					(HUDElementBase::Event::REPLAY_STAGE_2);
+				continue;
+			}
+
+			// A full drawing is timed across both stages.
+			LARGE_INTEGER start, end;
+			QueryPerformanceCounter (&start);
+			element.element.on_event
+				(HUDElementBase::Event::DRAW_STAGE_2);
+			QueryPerformanceCounter (&end);
+			record_hud_time (element, std::max (element.stage_1_ticks,
+				LONGLONG (0)) + end.QuadPart - start.QuadPart);
+		}
+	}
+	catch (...)
+	{
+		hud_frame_drawing = false;
+		finish_hud_iteration ();
+		throw;
+	}
+	hud_frame_drawing = false;
+	finish_hud_iteration ();
 }
 
 STDMETHODIMP_ (void)
 OSL::OnUIEnterMode ()
 {
-	for (auto& element : hud_elements)
-		element.element.on_event (HUDElementBase::Event::ENTER_GAME_MODE);
+	// The canvas size, and with it the font, may have changed.
+	forget_text_measurements ();
+	hud_frame_captured = false; // Recheck the config as well.
+	capture_hud_frame ();
+
+	iterating_hud_elements = true;
+	try
+	{
+		for (auto& element : hud_elements)
+			if (!element.removed)
+				element.element.on_event
+					(HUDElementBase::Event::ENTER_GAME_MODE);
+	}
+	catch (...)
+	{
+		finish_hud_iteration ();
+		throw;
+	}
+	finish_hud_iteration ();
 }
 
 STDMETHODIMP_ (bool)
@@ -186,25 +427,201 @@ OSL::register_hud_element (HUDElementBase& element,
 	if (!is_hud_handler)
 		try
 		{
-			SService<IDarkOverlaySrv> (LG)->SetHandler (self);
+			cached_service<IDarkOverlaySrv> ()->SetHandler (self);
 			is_hud_handler = true;
 		}
 		catch (...) { return false; }
-	hud_elements.emplace (element, priority);
+
+	if (iterating_hud_elements)
+		hud_element_changes.push_back ({ &element, priority, false });
+	else
+		place_hud_element (element, priority);
 	return true;
 }
 
 STDMETHODIMP_ (bool)
-OSL::unregister_hud_element (HUDElementBase& element)
+OSL::set_hud_element_budget (HUDElementBase& element, unsigned long budget)
+{
+	auto indexed = hud_element_index.find (&element);
+	if (indexed == hud_element_index.end () || indexed->second->removed)
+		return false;
+
+	const HUDElementInfo& entry = *indexed->second;
+	entry.stats.budget = budget;
+	entry.stats.interval = 1u;
+	entry.skipped = 0u;
+	return true;
+}
+
+STDMETHODIMP_ (bool)
+OSL::set_hud_element_priority (HUDElementBase& element,
+	HUDElementBase::ZIndex priority)
+{
+	if (!is_hud_element_registered (element)) return false;
+	if (iterating_hud_elements)
+		hud_element_changes.push_back ({ &element, priority, false });
+	else
+		place_hud_element (element, priority);
+	return true;
+}
+
+bool
+OSL::is_hud_element_registered (const HUDElementBase& element) const
+{
+	// The latest held change, if any, decides.
+	for (auto change = hud_element_changes.rbegin ();
+	     change != hud_element_changes.rend (); ++change)
+		if (change->element == &element)
+			return !change->remove;
+
+	auto indexed = hud_element_index.find (&element);
+	return indexed != hud_element_index.end () && !indexed->second->removed;
+}
+
+void
+OSL::place_hud_element (HUDElementBase& element,
+	HUDElementBase::ZIndex priority)
 {
-	for (auto entry = hud_elements.begin ();
-	     entry != hud_elements.end (); ++entry)
-		if (&entry->element == &element)
+	auto indexed = hud_element_index.find (&element);
+	if (indexed == hud_element_index.end ())
+	{
+		auto entry = hud_elements.emplace (element, priority,
+			hud_element_sequence++).first;
+		hud_element_index.emplace (&element, entry);
+		return;
+	}
+	if (indexed->second->priority == priority) return;
+
+	// The set is ordered by priority, so move the entry with its stats.
+	// It keeps its sequence, and with it its place among equals.
+	HUDElementInfo entry (*indexed->second);
+	entry.priority = entry.stats.priority = priority;
+	hud_elements.erase (indexed->second);
+	indexed->second = hud_elements.insert (entry).first;
+}
+
+void
+OSL::remove_hud_element (HUDElementBase& element)
+{
+	auto indexed = hud_element_index.find (&element);
+	if (indexed == hud_element_index.end ()) return;
+	hud_elements.erase (indexed->second);
+	hud_element_index.erase (indexed);
+}
+
+void
+OSL::finish_hud_iteration ()
+{
+	iterating_hud_elements = false;
+
+	// Changes are applied in order, as they would have been immediately.
+	std::vector<HUDElementChange> changes;
+	changes.swap (hud_element_changes);
+	for (auto& change : changes)
+		if (change.remove)
+			remove_hud_element (*change.element);
+		else
+			place_hud_element (*change.element, change.priority);
+}
+
+STDMETHODIMP_ (const HUDFrameContext&)
+OSL::get_hud_frame ()
+{
+	if (hud_frame_drawing)
+		return hud_frame;
+
+	// Outside a frame, the camera of the last frame drawn is still the one
+	// on screen; only the canvas may have changed since.
+	if (!hud_frame_captured)
+		capture_hud_frame ();
+	else
+	{
+		CanvasSize canvas_size = Engine::get_canvas_size ();
+		if (canvas_size.w != hud_frame.canvas_size.w ||
+		    canvas_size.h != hud_frame.canvas_size.h)
 		{
-			hud_elements.erase (entry);
-			return true;
+			hud_frame.canvas_size = canvas_size;
+			hud_frame.aspect_ratio = Engine::get_aspect_ratio ();
 		}
-	return false;
+	}
+	return hud_frame;
+}
+
+void
+OSL::capture_hud_frame ()
+{
+	hud_frame.canvas_size = Engine::get_canvas_size ();
+	hud_frame.aspect_ratio = Engine::get_aspect_ratio ();
+
+	if (!hud_frame_captured) // These rarely or never change in-game.
+	{
+		hud_frame.field_of_view = Engine::has_config ("fov")
+			? Engine::get_config<float> ("fov") : 90.0f;
+		hud_frame.camera_known =
+			Engine::get_version () >= Version (1, 22);
+	}
+
+	if (hud_frame.camera_known)
+	{
+		LGVector location, rotation;
+		cached_service<ICameraSrv> ()->GetPosition (location);
+		cached_service<ICameraSrv> ()->GetFacing (rotation);
+		hud_frame.camera_location = location;
+		hud_frame.camera_rotation = rotation;
+	}
+
+	hud_frame_captured = true;
+}
+
+STDMETHODIMP_ (const std::vector<HUDElementStats>&)
+OSL::get_hud_stats ()
+{
+	hud_stats.clear ();
+	for (auto& entry : hud_elements)
+		if (!entry.removed)
+			hud_stats.push_back (entry.stats);
+	return hud_stats;
+}
+
+// The most frames that an element over its budget can go between drawings.
+#define HUD_MAX_INTERVAL 8u
+
+void
+OSL::record_hud_time (const HUDElementInfo& element, LONGLONG ticks)
+{
+	HUDElementStats& stats = element.stats;
+	unsigned long time = (hud_timer_frequency > 0)
+		? ticks * 1000000 / hud_timer_frequency : 0ul;
+
+	// The average favors recent frames so that throttling can relax.
+	element.mean_time = (stats.draws++ == 0ul) ? time
+		: element.mean_time * 0.875 + time * 0.125;
+	element.skipped = 0u;
+	element.stage_1_ticks = -1;
+	stats.mean_time = element.mean_time;
+	stats.worst_time = std::max (stats.worst_time, time);
+
+	if (stats.budget > 0ul)
+		stats.interval = std::min (HUD_MAX_INTERVAL, std::max (1u,
+			unsigned (std::ceil (element.mean_time / stats.budget))));
+}
+
+STDMETHODIMP_ (bool)
+OSL::unregister_hud_element (HUDElementBase& element)
+{
+	if (!is_hud_element_registered (element)) return false;
+	if (!iterating_hud_elements)
+	{
+		remove_hud_element (element);
+		return true;
+	}
+
+	// The element may be destroyed before the iteration reaches it.
+	auto indexed = hud_element_index.find (&element);
+	if (indexed != hud_element_index.end ())
+		indexed->second->removed = true;
+	hud_element_changes.push_back ({ &element, 0, true });
+	return true;
 }
 
 STDMETHODIMP_ (HUDBitmap::Ptr)
@@ -218,24 +635,196 @@ OSL::load_hud_bitmap (const String& path, bool animation)
 	{
 		bitmap = existing->second.lock ();
 		if (bitmap)
+		{
+			++hud_bitmap_stats.hits;
+			retain_hud_bitmap (bitmap);
 			return bitmap;
+		}
 		else
 			hud_bitmaps.erase (existing);
 	}
 
-	try
+	// The bitmap hasn't been loaded yet, so load it now. If that fails, the
+	// engine may be out of bitmap handles, so free any that are only kept
+	// by the cache and try once more.
+	++hud_bitmap_stats.misses;
+	for (bool retry = true;; retry = false)
+		try
+		{
+			bitmap = HUDBitmap::Ptr (new HUDBitmap (path, animation));
+			hud_bitmaps.emplace (path, bitmap);
+			retain_hud_bitmap (bitmap);
+			break;
+		}
+		catch (std::exception& e)
+		{
+			if (retry && evict_idle_hud_bitmaps ())
+				continue;
+			mono.log (boost::format ("WARNING: Could not load bitmap "
+				"at \"%||\": %||.") % path % e.what ());
+			break;
+		}
+
+	return bitmap;
+}
+
+void
+OSL::retain_hud_bitmap (const HUDBitmap::Ptr& bitmap)
+{
+	bitmap->last_used = hud_frame.number;
+	if (hud_bitmap_stats.limit == 0u) return;
+
+	auto existing = std::find (retained_hud_bitmaps.begin (),
+		retained_hud_bitmaps.end (), bitmap);
+	if (existing != retained_hud_bitmaps.end ())
+		retained_hud_bitmaps.splice (retained_hud_bitmaps.begin (),
+			retained_hud_bitmaps, existing);
+	else
 	{
-		// The bitmap hasn't been loaded yet, so load it now.
-		bitmap = HUDBitmap::Ptr (new HUDBitmap (path, animation));
-		hud_bitmaps.emplace (path, bitmap);
+		retained_hud_bitmaps.push_front (bitmap);
+		++hud_bitmap_stats.bitmaps;
+		hud_bitmap_stats.frames += bitmap->count_frames ();
+		trim_hud_bitmaps ();
 	}
-	catch (std::exception& e)
+}
+
+void
+OSL::trim_hud_bitmaps ()
+{
+	if (hud_bitmap_stats.frames <= hud_bitmap_stats.limit) return;
+
+	// Bitmaps drawn since they were loaded move ahead of those that weren't.
+	retained_hud_bitmaps.sort ([] (const HUDBitmap::Ptr& a,
+		const HUDBitmap::Ptr& b) { return a->last_used > b->last_used; });
+
+	// The most recently used bitmap is kept even if it alone is too big.
+	while (hud_bitmap_stats.frames > hud_bitmap_stats.limit &&
+	       retained_hud_bitmaps.size () > 1u)
+		evict_hud_bitmap ();
+}
+
+void
+OSL::evict_hud_bitmap ()
+{
+	const HUDBitmap::Ptr& oldest = retained_hud_bitmaps.back ();
+	--hud_bitmap_stats.bitmaps;
+	hud_bitmap_stats.frames -= oldest->count_frames ();
+	++hud_bitmap_stats.evictions;
+	retained_hud_bitmaps.pop_back ();
+}
+
+void
+OSL::revalidate_hud_bitmaps ()
+{
+	for (auto iter = hud_bitmaps.begin (); iter != hud_bitmaps.end ();)
 	{
-		mono.log (boost::format ("WARNING: Could not load bitmap at "
-			"\"%||\": %||.") % path % e.what ());
+		HUDBitmap::Ptr bitmap = iter->second.lock ();
+		if (bitmap && bitmap->revalidate ())
+		{
+			++iter;
+			continue;
+		}
+
+		// A later load will try the bitmap afresh.
+		if (bitmap)
+			retained_hud_bitmaps.remove (bitmap);
+		iter = hud_bitmaps.erase (iter);
 	}
 
-	return bitmap;
+	// Frames may have been lost along with whole bitmaps.
+	hud_bitmap_stats.bitmaps = retained_hud_bitmaps.size ();
+	hud_bitmap_stats.frames = 0u;
+	for (auto& bitmap : retained_hud_bitmaps)
+		hud_bitmap_stats.frames += bitmap->count_frames ();
+}
+
+bool
+OSL::evict_idle_hud_bitmaps ()
+{
+	// Only bitmaps with no other handle will actually be unloaded.
+	bool evicted = false;
+	for (auto iter = retained_hud_bitmaps.begin ();
+	     iter != retained_hud_bitmaps.end ();)
+		if (iter->use_count () == 1)
+		{
+			--hud_bitmap_stats.bitmaps;
+			hud_bitmap_stats.frames -= (*iter)->count_frames ();
+			++hud_bitmap_stats.evictions;
+			iter = retained_hud_bitmaps.erase (iter);
+			evicted = true;
+		}
+		else
+			++iter;
+	return evicted;
+}
+
+STDMETHODIMP_ (HUDBitmap::CacheStats)
+OSL::get_hud_bitmap_cache_stats ()
+{
+	return hud_bitmap_stats;
+}
+
+STDMETHODIMP_ (void)
+OSL::set_hud_bitmap_cache_limit (HUDBitmap::Frame limit)
+{
+	hud_bitmap_stats.limit = limit;
+	if (limit == 0u)
+		while (!retained_hud_bitmaps.empty ())
+			evict_hud_bitmap ();
+	else
+		trim_hud_bitmaps ();
+}
+
+STDMETHODIMP_ (bool)
+OSL::preload_hud_bitmap (const String& path, bool animation)
+{
+	HUDBitmap::Ptr bitmap = load_hud_bitmap (path, animation);
+	if (bitmap)
+		preloaded_hud_bitmaps.insert (bitmap);
+	return bool (bitmap);
+}
+
+// The number of distinct strings whose measurements are kept.
+#define TEXT_CACHE_SIZE 256
+
+STDMETHODIMP_ (CanvasSize)
+OSL::measure_text (const String& text)
+{
+	auto cached = text_index.find (text);
+	if (cached != text_index.end ())
+	{
+		text_measurements.splice (text_measurements.begin (),
+			text_measurements, cached->second);
+		return cached->second->size;
+	}
+
+	CanvasSize size;
+	cached_service<IDarkOverlaySrv> ()->GetStringSize
+		(text.data (), size.w, size.h);
+
+	if (text_measurements.size () >= TEXT_CACHE_SIZE)
+	{
+		text_index.erase (text_measurements.back ().text);
+		text_measurements.pop_back ();
+	}
+	text_measurements.push_front ({ text, size });
+	text_index.emplace (text, text_measurements.begin ());
+
+	return size;
+}
+
+STDMETHODIMP_ (unsigned long)
+OSL::get_text_generation ()
+{
+	return text_generation;
+}
+
+void
+OSL::forget_text_measurements ()
+{
+	text_index.clear ();
+	text_measurements.clear ();
+	++text_generation;
 }
 
 
@@ -260,7 +849,7 @@ OSL::subscribe_links (const Flavor& flavor, const Object& source,
 	Object host = (_host == Object::SELF) ? source : _host;
 
 	IRelation* relation =
-		SInterface<ILinkManager> (LG)->GetRelation (flavor.number);
+		cached_interface<ILinkManager> ()->GetRelation (flavor.number);
 	if (!relation || relation->GetID () == 0 || host == Object::NONE)
 		return false; //TODO Allow subscription to all flavors.
 
@@ -461,7 +1050,7 @@ OSL::subscribe_conversation (const Object& conversation, const Object& _host)
 
 	if (!listened_conversations)
 	{
-		SInterface<IAIManager> (LG)->GetConversationManager ()->
+		cached_interface<IAIManager> ()->GetConversationManager ()->
 			ListenConversationEnd (on_conversation_end);
 		listened_conversations = true;
 	}
@@ -512,6 +1101,223 @@ OSL::on_conversation_end (Object::Number conversation)
 
 
 
+// OSL: Timer messages
+
+STDMETHODIMP_ (Timer)
+OSL::start_timer (sScrMsg* message, Time delay, bool repeating,
+	const Object& host, Time now)
+{
+	try
+	{
+		return timer_wheel.start (message, delay, repeating, host, now);
+	}
+	catch (std::exception& e)
+	{
+		mono.log (boost::format ("WARNING: Could not start timer: %||.")
+			% e.what ());
+	}
+	catch (...) {}
+	return Timer ();
+}
+
+STDMETHODIMP_ (bool)
+OSL::cancel_timer (const Timer& timer)
+{
+	try
+	{
+		return timer_wheel.cancel (timer);
+	}
+	catch (...) {}
+	return false;
+}
+
+STDMETHODIMP_ (void)
+OSL::advance_timers (Time now, int tick)
+{
+	try
+	{
+		timer_wheel.advance (now, tick);
+	}
+	catch (std::exception& e)
+	{
+		mono.log (boost::format ("WARNING: Could not advance timers: "
+			"%||.") % e.what ());
+	}
+	catch (...) {}
+}
+
+STDMETHODIMP_ (void)
+OSL::flush_timers ()
+{
+	try
+	{
+		timer_wheel.flush ();
+	}
+	catch (std::exception& e)
+	{
+		mono.log (boost::format ("WARNING: Could not save timers: %||.")
+			% e.what ());
+	}
+	catch (...) {}
+}
+
+STDMETHODIMP_ (void)
+OSL::retain_timer_host (const Object& host)
+{
+	try
+	{
+		timer_wheel.host_added (host);
+	}
+	catch (...) {}
+}
+
+STDMETHODIMP_ (void)
+OSL::release_timer_host (const Object& host)
+{
+	try
+	{
+		timer_wheel.host_removed (host);
+	}
+	catch (std::exception& e)
+	{
+		mono.log (boost::format ("WARNING: Could not move timer tick off "
+			"%||: %||.") % host % e.what ());
+	}
+	catch (...) {}
+}
+
+
+
+// OSL: Queued broadcasts
+
+// The most messages delivered in one drain of the queue, beyond which a
+// runaway trigger network is cut off.
+static const size_t BROADCAST_BUDGET = 1000u;
+
+STDMETHODIMP_ (void)
+OSL::queue_broadcast (sScrMsg* message, const Link::List& links)
+{
+	if (!message || !message->message) return;
+
+	// The caller's message and its name may be gone once it returns.
+	const CIString* name = &*broadcast_names.insert
+		(CIString (message->message)).first;
+	for (auto& link : links)
+	{
+		broadcast_queue.emplace_back ();
+		QueuedMessage& entry = broadcast_queue.back ();
+		entry.name = name;
+		entry.from = link.get_source ();
+		entry.to = link.get_dest ();
+		static_cast<LGMultiBase&> (entry.data [0]) = message->data;
+		static_cast<LGMultiBase&> (entry.data [1]) = message->data2;
+		static_cast<LGMultiBase&> (entry.data [2]) = message->data3;
+		entry.parent = current_broadcast;
+	}
+
+	// Broadcasts queued by the recipients' handlers are drained below.
+	if (draining_broadcasts) return;
+	draining_broadcasts = true;
+
+	size_t sent = 0u, dropped = 0u;
+
+	while (!broadcast_queue.empty ())
+	{
+		QueuedMessage next = broadcast_queue.front ();
+		broadcast_queue.pop_front ();
+
+		// Skip a message that would repeat a delivery that led to it.
+		bool cycle = false;
+		for (int index = next.parent; index >= 0 && !cycle;
+		     index = broadcast_deliveries [index].parent)
+			cycle = broadcast_deliveries [index].to == next.to &&
+				broadcast_deliveries [index].name == next.name;
+		if (cycle) continue;
+
+		if (sent >= BROADCAST_BUDGET)
+		{
+			++dropped;
+			continue;
+		}
+
+		broadcast_deliveries.push_back ({ next.to, next.name,
+			next.parent });
+		current_broadcast = broadcast_deliveries.size () - 1;
+		try
+		{
+			// Each recipient gets a fresh copy of the message.
+			GenericMessage copy (next.name->data ());
+			for (size_t index = 0; index < 3; ++index)
+				if (!next.data [index].empty ())
+					copy.set_data (Message::Slot (index),
+						(const sMultiParm&) next.data [index]);
+			copy.send (next.from, next.to);
+			++sent;
+		}
+		catch (...) {}
+		current_broadcast = -1;
+	}
+
+	broadcast_deliveries.clear ();
+	draining_broadcasts = false;
+
+	if (dropped > 0u)
+		mono.log (boost::format ("WARNING: A queued broadcast exceeded "
+			"the budget of %|| messages; %|| more were dropped.")
+			% BROADCAST_BUDGET % dropped);
+}
+
+
+
+// OSL: Cooperative jobs
+
+// The total time, in microseconds, that jobs may take in one frame.
+static const unsigned long JOB_FRAME_BUDGET = 2000ul;
+
+// Jobs that haven't run in this long are presumed abandoned (for example,
+// their host was destroyed) and no longer take a share of the budget.
+static const Time::Value JOB_STALE_TIME = 1000ul;
+
+STDMETHODIMP_ (unsigned long)
+OSL::begin_job (const Object& host, const char* script, const char* job,
+	unsigned long budget, Time now)
+{
+	Time::Value _now = Time::Value (now);
+	if (_now != job_frame)
+	{
+		job_frame = _now;
+		job_frame_spent = 0ul;
+
+		for (auto iter = jobs.begin (); iter != jobs.end ();)
+			if (_now - iter->second > JOB_STALE_TIME)
+				iter = jobs.erase (iter);
+			else
+				++iter;
+	}
+
+	jobs [JobKey (host, script, job)] = _now;
+
+	if (job_frame_spent >= JOB_FRAME_BUDGET)
+		return 0ul; // Wait for the next frame.
+
+	// Each job gets a fair share of the frame, within its own budget. At
+	// least one step is always taken once a job is allowed to run.
+	unsigned long share = JOB_FRAME_BUDGET / jobs.size ();
+	return std::max (1ul, std::min ({ budget, share,
+		JOB_FRAME_BUDGET - job_frame_spent }));
+}
+
+STDMETHODIMP_ (void)
+OSL::end_job (const Object& host, const char* script, const char* job,
+	unsigned long spent, bool finished)
+{
+	job_frame_spent += spent;
+	if (finished)
+		jobs.erase (JobKey (host, script, job));
+}
+
+
+
 } // namespace Thief
 
 
@@ -541,6 +1347,7 @@ ThiefLibOSLInit (IScriptMan* manager, MPrintfProc mprintf, IMalloc* allocator)
 		Thief::OSL* osl = new Thief::OSL ();
 		manager->ExposeService (osl, Thief::IID_IOSLService);
 		osl->Init (); // ExposeService apparently doesn't do this.
+		Thief::ServiceCache::attach ();
 	}
 	catch (std::exception& e)
 	{
@@ -570,7 +1377,8 @@ DllMain (HINSTANCE dll, DWORD reason, PVOID reserved)
 {
 	if (reason == DLL_PROCESS_ATTACH)
 		::DisableThreadLibraryCalls (dll);
-	(void) reserved;
+	else if (reason == DLL_PROCESS_DETACH && !reserved)
+		Thief::ServiceCache::detach (); // not if the process is exiting
 	return true;
 }
 
@@ -26,6 +26,9 @@
 
 #include "Private.hh"
 #include "ParameterCache.hh"
+#include "TimerWheel.hh"
+#include <list>
+#include <tuple>
 
 
 
@@ -47,11 +50,37 @@ interface IOSLService : IScriptServiceBase
 {
 	STDMETHOD_ (ParameterCache*, get_param_cache) () PURE;
 
+	// Incremented whenever an object is created or destroyed.
+	STDMETHOD_ (const unsigned long*, get_object_generation) () PURE;
+
+	STDMETHOD_ (const String&, get_object_name) (Object::Number) PURE;
+	STDMETHOD_ (Object::Number, find_object) (const char* name) PURE;
+	STDMETHOD_ (void, forget_object_name) (Object::Number) PURE;
+
 	STDMETHOD_ (bool, register_hud_element) (HUDElementBase&,
 		HUDElementBase::ZIndex priority) PURE;
 	STDMETHOD_ (bool, unregister_hud_element) (HUDElementBase&) PURE;
+	STDMETHOD_ (bool, set_hud_element_priority) (HUDElementBase&,
+		HUDElementBase::ZIndex priority) PURE;
+	STDMETHOD_ (bool, set_hud_element_budget) (HUDElementBase&,
+		unsigned long budget) PURE;
+	STDMETHOD_ (const std::vector<HUDElementStats>&, get_hud_stats) ()
+		PURE;
+	STDMETHOD_ (const HUDFrameContext&, get_hud_frame) () PURE;
 	STDMETHOD_ (HUDBitmap::Ptr, load_hud_bitmap) (const String& path,
 		bool animation) PURE;
+	STDMETHOD_ (HUDBitmap::CacheStats, get_hud_bitmap_cache_stats) ()
+		PURE;
+	STDMETHOD_ (void, set_hud_bitmap_cache_limit) (HUDBitmap::Frame)
+		PURE;
+	// Holds the bitmap until the end of the sim.
+	STDMETHOD_ (bool, preload_hud_bitmap) (const String& path,
+		bool animation) PURE;
+
+	// Only valid during a HUD drawing cycle.
+	STDMETHOD_ (CanvasSize, measure_text) (const String&) PURE;
+	// Incremented whenever cached text measurements become invalid.
+	STDMETHOD_ (unsigned long, get_text_generation) () PURE;
 
 	STDMETHOD_ (bool, subscribe_links) (const Flavor&,
 		const Object& source, const Object& host) PURE;
@@ -67,6 +96,23 @@ interface IOSLService : IScriptServiceBase
 		const Object& host) PURE;
 	STDMETHOD_ (bool, unsubscribe_conversation) (const Object& conversation,
 		const Object& host) PURE;
+
+	STDMETHOD_ (Timer, start_timer) (sScrMsg* message, Time delay,
+		bool repeating, const Object& host, Time now) PURE;
+	STDMETHOD_ (bool, cancel_timer) (const Timer&) PURE;
+	STDMETHOD_ (void, advance_timers) (Time now, int tick) PURE;
+	STDMETHOD_ (void, flush_timers) () PURE;
+	STDMETHOD_ (void, retain_timer_host) (const Object& host) PURE;
+	STDMETHOD_ (void, release_timer_host) (const Object& host) PURE;
+
+	STDMETHOD_ (void, queue_broadcast) (sScrMsg* message,
+		const Link::List& links) PURE;
+
+	STDMETHOD_ (unsigned long, begin_job) (const Object& host,
+		const char* script, const char* job, unsigned long budget,
+		Time now) PURE;
+	STDMETHOD_ (void, end_job) (const Object& host, const char* script,
+		const char* job, unsigned long spent, bool finished) PURE;
 };
 
 extern "C" const GUID IID_IOSLService;
@@ -96,11 +142,30 @@ public:
 
 	STDMETHOD_ (ParameterCache*, get_param_cache) ();
 
+	STDMETHOD_ (const unsigned long*, get_object_generation) ();
+
+	STDMETHOD_ (const String&, get_object_name) (Object::Number);
+	STDMETHOD_ (Object::Number, find_object) (const char* name);
+	STDMETHOD_ (void, forget_object_name) (Object::Number);
+
 	STDMETHOD_ (bool, register_hud_element) (HUDElementBase&,
 		HUDElementBase::ZIndex priority);
 	STDMETHOD_ (bool, unregister_hud_element) (HUDElementBase&);
+	STDMETHOD_ (bool, set_hud_element_priority) (HUDElementBase&,
+		HUDElementBase::ZIndex priority);
+	STDMETHOD_ (bool, set_hud_element_budget) (HUDElementBase&,
+		unsigned long budget);
+	STDMETHOD_ (const std::vector<HUDElementStats>&, get_hud_stats) ();
+	STDMETHOD_ (const HUDFrameContext&, get_hud_frame) ();
 	STDMETHOD_ (HUDBitmap::Ptr, load_hud_bitmap) (const String& path,
 		bool animation);
+	STDMETHOD_ (HUDBitmap::CacheStats, get_hud_bitmap_cache_stats) ();
+	STDMETHOD_ (void, set_hud_bitmap_cache_limit) (HUDBitmap::Frame);
+	STDMETHOD_ (bool, preload_hud_bitmap) (const String& path,
+		bool animation);
+
+	STDMETHOD_ (CanvasSize, measure_text) (const String&);
+	STDMETHOD_ (unsigned long, get_text_generation) ();
 
 	STDMETHOD_ (bool, subscribe_links) (const Flavor&,
 		const Object& source, const Object& host);
@@ -117,6 +182,23 @@ public:
 	STDMETHOD_ (bool, unsubscribe_conversation) (const Object& conversation,
 		const Object& host);
 
+	STDMETHOD_ (Timer, start_timer) (sScrMsg* message, Time delay,
+		bool repeating, const Object& host, Time now);
+	STDMETHOD_ (bool, cancel_timer) (const Timer&);
+	STDMETHOD_ (void, advance_timers) (Time now, int tick);
+	STDMETHOD_ (void, flush_timers) ();
+	STDMETHOD_ (void, retain_timer_host) (const Object& host);
+	STDMETHOD_ (void, release_timer_host) (const Object& host);
+
+	STDMETHOD_ (void, queue_broadcast) (sScrMsg* message,
+		const Link::List& links);
+
+	STDMETHOD_ (unsigned long, begin_job) (const Object& host,
+		const char* script, const char* job, unsigned long budget,
+		Time now);
+	STDMETHOD_ (void, end_job) (const Object& host, const char* script,
+		const char* job, unsigned long spent, bool finished);
+
 private:
 	static OSL* self;
 
@@ -128,26 +210,110 @@ private:
 
 	std::unique_ptr<ParameterCacheImpl> param_cache;
 
+	// Object existence
+
+	static void __stdcall on_object_event (int, eObjNotifyMsg, void*);
+
+	unsigned long object_generation;
+	int object_listen_handle;
+
+	typedef std::unordered_map<Object::Number, String> ObjectNames;
+	ObjectNames object_names; // only named objects
+
 	// HUD
 
 	bool is_hud_handler;
 
 	struct HUDElementInfo
 	{
-		HUDElementInfo (HUDElementBase&, HUDElementBase::ZIndex);
+		HUDElementInfo (HUDElementBase&, HUDElementBase::ZIndex,
+			unsigned long sequence);
 		bool operator == (const HUDElementInfo&) const;
 		bool operator < (const HUDElementInfo&) const;
 
 		HUDElementBase& element;
 		HUDElementBase::ZIndex priority;
+		unsigned long sequence; // of registration, to order ties
+
+		// Set when unregistered while the elements are being iterated.
+		mutable bool removed;
+
+		// Timing and throttling of drawing; see DrawHUD and DrawTOverlay.
+		mutable HUDElementStats stats;
+		mutable double mean_time; // in microseconds
+		mutable unsigned skipped; // frames since the last full drawing
+		mutable bool replaying; // in the current frame
+		mutable LONGLONG stage_1_ticks; // until recorded, then -1
 	};
 
 	typedef std::set<HUDElementInfo> HUDElements;
 	HUDElements hud_elements;
 
+	typedef std::unordered_map<const HUDElementBase*, HUDElements::iterator>
+		HUDElementIndex;
+	HUDElementIndex hud_element_index;
+	unsigned long hud_element_sequence;
+
+	// Elements may register, unregister, or change priority while being
+	// drawn, so those changes are held until the iteration is over.
+	struct HUDElementChange
+	{
+		HUDElementBase* element;
+		HUDElementBase::ZIndex priority;
+		bool remove;
+	};
+	std::vector<HUDElementChange> hud_element_changes;
+	bool iterating_hud_elements;
+
+	bool is_hud_element_registered (const HUDElementBase&) const;
+	void place_hud_element (HUDElementBase&, HUDElementBase::ZIndex);
+	void remove_hud_element (HUDElementBase&);
+	void finish_hud_iteration ();
+
+	std::vector<HUDElementStats> hud_stats;
+	LONGLONG hud_timer_frequency;
+
+	void record_hud_time (const HUDElementInfo&, LONGLONG ticks);
+
+	// The snapshot is only trusted while a frame is being drawn.
+	HUDFrameContext hud_frame;
+	bool hud_frame_captured, hud_frame_drawing;
+	void capture_hud_frame ();
+
 	typedef std::map<String, std::weak_ptr<HUDBitmap>> HUDBitmaps;
 	HUDBitmaps hud_bitmaps;
 
+	// Recently loaded bitmaps, most recent first. Drawing doesn't reorder
+	// the list, so it is sorted by last use before any are evicted.
+	typedef std::list<HUDBitmap::Ptr> RetainedHUDBitmaps;
+	RetainedHUDBitmaps retained_hud_bitmaps;
+	HUDBitmap::CacheStats hud_bitmap_stats;
+
+	void retain_hud_bitmap (const HUDBitmap::Ptr&);
+	void trim_hud_bitmaps ();
+	void evict_hud_bitmap ();
+	bool evict_idle_hud_bitmaps ();
+	void revalidate_hud_bitmaps ();
+
+	typedef std::set<HUDBitmap::Ptr> PreloadedHUDBitmaps;
+	PreloadedHUDBitmaps preloaded_hud_bitmaps;
+
+	struct TextMeasurement
+	{
+		String text;
+		CanvasSize size;
+	};
+
+	typedef std::list<TextMeasurement> TextMeasurements;
+	TextMeasurements text_measurements; // most recently used first
+
+	typedef std::unordered_map<String, TextMeasurements::iterator>
+		TextIndex;
+	TextIndex text_index;
+	unsigned long text_generation;
+
+	void forget_text_measurements ();
+
 	// LinkCreate, LinkChange, and LinkDestroy messages
 
 	static void __stdcall on_link_event (sRelationListenMsg*, void*);
@@ -183,6 +349,43 @@ private:
 
 	typedef std::multimap<Object, Object> ConversationSubscriptions;
 	ConversationSubscriptions conversation_subscriptions;
+
+	// Timer messages
+
+	TimerWheel timer_wheel;
+
+	// Queued broadcasts
+
+	struct QueuedMessage
+	{
+		const CIString* name; // interned in broadcast_names
+		Object from, to;
+		LGMulti<sMultiParm> data [3];
+		int parent; // the delivery that queued it, or -1
+	};
+	typedef std::deque<QueuedMessage> BroadcastQueue;
+	BroadcastQueue broadcast_queue;
+	bool draining_broadcasts;
+
+	// Names outlive their deliveries in case a recipient posts the message.
+	std::set<CIString> broadcast_names;
+
+	struct BroadcastDelivery
+	{
+		Object to;
+		const CIString* name;
+		int parent;
+	};
+	std::vector<BroadcastDelivery> broadcast_deliveries; // in this drain
+	int current_broadcast;
+
+	// Cooperative jobs
+
+	typedef std::tuple<Object, CIString, CIString> JobKey;
+	typedef std::map<JobKey, Time::Value> Jobs; // to last sim time run
+	Jobs jobs;
+	Time::Value job_frame;
+	unsigned long job_frame_spent; // in microseconds
 };
 
 #endif // IS_OSL
@@ -22,18 +22,87 @@
  *****************************************************************************/
 
 #include "Private.hh"
+#include "OSL.hh"
 
 namespace Thief {
 
 
 
+// ExistenceCache
+
+ExistenceCache::Entry
+ExistenceCache::entries [SIZE] = {};
+
+unsigned
+ExistenceCache::depth = 0u;
+
+unsigned long
+ExistenceCache::dispatch = 0ul;
+
+const unsigned long*
+ExistenceCache::generation = nullptr;
+
+ExistenceCache::Dispatch::Dispatch ()
+{
+	if (depth++ > 0u) return;
+	++dispatch; // Nothing is carried over between dispatches.
+
+	if (!generation)
+		try
+		{
+			generation = cached_service<IOSLService> ()->
+				get_object_generation ();
+		}
+		catch (...) {} // Leave the cache disabled.
+}
+
+ExistenceCache::Dispatch::~Dispatch ()
+{
+	--depth;
+}
+
+bool
+ExistenceCache::lookup (Object::Number number, bool& exists)
+{
+	if (depth == 0u || !generation) return false;
+
+	const Entry& entry = entries [unsigned (number) % SIZE];
+	if (entry.number != number || entry.dispatch != dispatch ||
+	    entry.generation != *generation)
+		return false;
+
+	exists = entry.exists;
+	return true;
+}
+
+void
+ExistenceCache::store (Object::Number number, bool exists)
+{
+	if (depth == 0u || !generation) return;
+	entries [unsigned (number) % SIZE] =
+		{ number, exists, dispatch, *generation };
+}
+
+void
+ExistenceCache::invalidate ()
+{
+	++dispatch;
+}
+
+
+
 // Locating and wrapping objects
 
 bool
 Object::exists () const
 {
+	bool cached;
+	if (ExistenceCache::lookup (number, cached))
+		return cached;
+
 	LGBool _exists;
-	SService<IObjectSrv> (LG)->Exists (_exists, number);
+	cached_service<IObjectSrv> ()->Exists (_exists, number);
+	ExistenceCache::store (number, _exists);
 	return _exists;
 }
 
@@ -42,7 +111,7 @@ Object
 Object::find_closest (const Object& archetype, const Object& nearby)
 {
 	LGObject closest;
-	SService<IObjectSrv> (LG)->FindClosestObjectNamed (closest,
+	cached_service<IObjectSrv> ()->FindClosestObjectNamed (closest,
 		nearby.number, archetype.get_name ().data ());
 	return closest;
 }
@@ -56,7 +125,8 @@ Object
 Object::create (const Object& archetype)
 {
 	LGObject created;
-	SService<IObjectSrv> (LG)->Create (created, archetype.number);
+	cached_service<IObjectSrv> ()->Create (created, archetype.number);
+	ExistenceCache::invalidate ();
 	return created;
 }
 
@@ -64,14 +134,15 @@ Object
 Object::start_create (const Object& archetype)
 {
 	LGObject created;
-	SService<IObjectSrv> (LG)->BeginCreate (created, archetype.number);
+	cached_service<IObjectSrv> ()->BeginCreate (created, archetype.number);
+	ExistenceCache::invalidate ();
 	return created;
 }
 
 void
 Object::finish_create ()
 {
-	if (SService<IObjectSrv> (LG)->EndCreate (number) != S_OK)
+	if (cached_service<IObjectSrv> ()->EndCreate (number) != S_OK)
 		throw std::runtime_error ("could not finish creating object");
 }
 
@@ -88,14 +159,14 @@ Object::create_temp_fnord (Time lifespan)
 Object
 Object::create_archetype (const Object& parent, const String& name)
 {
-	return Object (SInterface<ITraitManager> (LG)->CreateArchetype
+	return Object (cached_interface<ITraitManager> ()->CreateArchetype
 		(name.data (), parent.number));
 }
 
 Object
 Object::create_metaprop (const Object& parent, const String& name)
 {
-	return Object (SInterface<ITraitManager> (LG)->CreateMetaProperty
+	return Object (cached_interface<ITraitManager> ()->CreateMetaProperty
 		(name.data (), parent.number));
 }
 
@@ -108,7 +179,8 @@ Object::clone () const
 void
 Object::destroy ()
 {
-	SService<IObjectSrv> (LG)->Destroy (number);
+	cached_service<IObjectSrv> ()->Destroy (number);
+	ExistenceCache::invalidate ();
 }
 
 void
@@ -142,15 +214,14 @@ Object::SELF { INT_MAX };
 String
 Object::get_name () const
 {
-	LGString name;
-	SService<IObjectSrv> (LG)->GetName (name, number);
-	return name;
+	return cached_service<IOSLService> ()->get_object_name (number);
 }
 
 void
 Object::set_name (const String& name)
 {
-	SService<IObjectSrv> (LG)->SetName (number, name.data ());
+	cached_service<IObjectSrv> ()->SetName (number, name.data ());
+	cached_service<IOSLService> ()->forget_object_name (number);
 }
 
 String
@@ -181,7 +252,7 @@ String
 Object::get_display_name () const
 {
 	LGString name;
-	SService<IDataSrv> (LG)->GetObjString (name, number, "objnames");
+	cached_service<IDataSrv> ()->GetObjString (name, number, "objnames");
 	return name;
 }
 
@@ -190,7 +261,7 @@ String
 Object::get_description () const
 {
 	LGString desc;
-	SService<IDataSrv> (LG)->GetObjString (desc, number, "objdescs");
+	cached_service<IDataSrv> ()->GetObjString (desc, number, "objdescs");
 	return desc;
 }
 
@@ -203,9 +274,9 @@ Object::get_type () const
 {
 	if (!exists ())
 		return Type::NONE;
-	else if (SInterface<ITraitManager> (LG)->IsArchetype (number))
+	else if (cached_interface<ITraitManager> ()->IsArchetype (number))
 		return Type::ARCHETYPE;
-	else if (SInterface<ITraitManager> (LG)->IsMetaProperty (number))
+	else if (cached_interface<ITraitManager> ()->IsMetaProperty (number))
 		return Type::METAPROPERTY;
 	else
 		return Type::CONCRETE;
@@ -215,7 +286,7 @@ bool
 Object::inherits_from (const Object& ancestor) const
 {
 	LGBool inherits;
-	SService<IObjectSrv> (LG)->InheritsFrom
+	cached_service<IObjectSrv> ()->InheritsFrom
 		(inherits, number, ancestor.number);
 	return inherits;
 }
@@ -224,7 +295,7 @@ Object::List
 Object::get_ancestors () const
 {
 	SInterface<IObjectQuery> _ancestors =
-		SInterface<ITraitManager> (LG)->Query
+		cached_interface<ITraitManager> ()->Query
 			(number, kTraitQueryMetaProps | kTraitQueryFull);
 
 	List ancestors;
@@ -243,7 +314,7 @@ Object::get_descendants (bool include_indirect) const
 	unsigned flags = kTraitQueryChildren;
 	if (include_indirect) flags |= kTraitQueryFull;
 	SInterface<IObjectQuery> _descendants =
-		SInterface<ITraitManager> (LG)->Query (number, flags);
+		cached_interface<ITraitManager> ()->Query (number, flags);
 
 	List descendants;
 
@@ -257,20 +328,22 @@ Object::get_descendants (bool include_indirect) const
 Object
 Object::get_archetype () const
 {
-	return Object (SInterface<ITraitManager> (LG)->GetArchetype (number));
+	return Object (cached_interface<ITraitManager> ()->GetArchetype
+		(number));
 }
 
 void
 Object::set_archetype (const Object& archetype)
 {
-	SInterface<ITraitManager> (LG)->SetArchetype (number, archetype.number);
+	cached_interface<ITraitManager> ()->SetArchetype (number,
+		archetype.number);
 }
 
 bool
 Object::has_metaprop (const Object& metaprop) const
 {
 	LGBool has;
-	SService<IObjectSrv> (LG)->HasMetaProperty
+	cached_service<IObjectSrv> ()->HasMetaProperty
 		(has, number, metaprop.number);
 	return has;
 }
@@ -279,7 +352,8 @@ bool
 Object::add_metaprop (const Object& metaprop, bool single)
 {
 	if (single && has_metaprop (metaprop)) return false;
-	SService<IObjectSrv> (LG)->AddMetaProperty (number, metaprop.number);
+	cached_service<IObjectSrv> ()->AddMetaProperty (number,
+		metaprop.number);
 	return true;
 }
 
@@ -287,7 +361,8 @@ bool
 Object::remove_metaprop (const Object& metaprop)
 {
 	if (!has_metaprop (metaprop)) return false;
-	SService<IObjectSrv> (LG)->RemoveMetaProperty (number, metaprop.number);
+	cached_service<IObjectSrv> ()->RemoveMetaProperty (number,
+		metaprop.number);
 	return true;
 }
 
@@ -295,14 +370,14 @@ bool
 Object::is_transient () const
 {
 	LGBool transient;
-	SService<IObjectSrv> (LG)->IsTransient (transient, number);
+	cached_service<IObjectSrv> ()->IsTransient (transient, number);
 	return transient;
 }
 
 void
 Object::set_transient (bool transient)
 {
-	SService<IObjectSrv> (LG)->SetTransience (number, transient);
+	cached_service<IObjectSrv> ()->SetTransience (number, transient);
 }
 
 
@@ -313,7 +388,7 @@ Vector
 Object::get_location () const
 {
 	LGVector location;
-	SService<IObjectSrv> (LG)->Position (location, number);
+	cached_service<IObjectSrv> ()->Position (location, number);
 	return location;
 }
 
@@ -327,7 +402,7 @@ Vector
 Object::get_rotation () const
 {
 	LGVector rotation;
-	SService<IObjectSrv> (LG)->Facing (rotation, number);
+	cached_service<IObjectSrv> ()->Facing (rotation, number);
 	return rotation;
 }
 
@@ -341,7 +416,7 @@ void
 Object::set_position (const Vector& location, const Vector& rotation,
 	const Object& relative)
 {
-	SService<IObjectSrv> (LG)->Teleport (number,
+	cached_service<IObjectSrv> ()->Teleport (number,
 		LGVector (location), LGVector (rotation),
 		(relative == SELF) ? number : relative.number);
 }
@@ -350,7 +425,7 @@ Vector
 Object::object_to_world (const Vector& relative) const
 {
 	LGVector absolute;
-	SService<IObjectSrv> (LG)->ObjectToWorld
+	cached_service<IObjectSrv> ()->ObjectToWorld
 		(absolute, number, LGVector (relative));
 	return absolute;
 }
@@ -362,7 +437,7 @@ Object::object_to_world (const Vector& relative) const
 Object
 Object::get_container () const
 {
-	return Object (SInterface<IContainSys> (LG)->GetContainer (number));
+	return Object (cached_interface<IContainSys> ()->GetContainer (number));
 }
 
 bool
@@ -377,18 +452,17 @@ Object::~Object ()
 Object::Number
 Object::find (const String& name)
 {
-	LGObject named;
-	SService<IObjectSrv> (LG)->Named (named, name.data ());
-	if (named) return named;
-
-	Object numbered;
-	try
+	// A string of digits is taken as the number of an existing object.
+	if (!name.empty ())
 	{
-		numbered.number = std::stoi (name, nullptr, 10);
+		char* end = nullptr;
+		Object numbered;
+		numbered.number = std::strtol (name.data (), &end, 10);
+		if (end && *end == '\0' && numbered.exists ())
+			return numbered.number;
 	}
-	catch (...) {}
 
-	return numbered.exists () ? numbered.number : NONE.number;
+	return cached_service<IOSLService> ()->find_object (name.data ());
 }
 
 std::ostream&
@@ -112,7 +112,8 @@ ParameterBase::reparse () const
 void
 ParameterBase::dump_cache ()
 {
-	ParameterCache* cache = SService<IOSLService> (LG)->get_param_cache ();
+	ParameterCache* cache = cached_service<IOSLService> ()->get_param_cache
+		();
 	if (!cache)
 		throw std::runtime_error ("could not access parameter cache");
 	cache->dump (mono);
@@ -123,7 +124,7 @@ ParameterBase::initialize () const
 {
 	if (!cache)
 	{
-		cache = SService<IOSLService> (LG)->get_param_cache ();
+		cache = cached_service<IOSLService> ()->get_param_cache ();
 		if (!cache)
 			throw std::runtime_error
 				("could not access parameter cache");
@@ -185,16 +185,17 @@ DesignNoteReader::DesignNoteReader (const char* dn, RawValues& _raw_values)
 // ParameterCacheImpl
 
 ParameterCacheImpl::ParameterCacheImpl ()
-	: dn_prop (static_cast<IStringProperty*> (SInterface<IPropertyManager>
-		(LG)->GetPropertyNamed ("DesignNote"))),
-	  listen_handle (nullptr)
+	: dn_prop (static_cast<IStringProperty*> (cached_interface
+		<IPropertyManager> ()->GetPropertyNamed ("DesignNote"))),
+	  listen_handle (nullptr),
+	  debug_params_indexed (false)
 {
 	if (!dn_prop)
 		throw MissingResource (MissingResource::PROPERTY, "DesignNote",
 			Object::NONE);
 	listen_handle = dn_prop->Listen (kPropertyFull, on_dn_change,
 		reinterpret_cast<PropListenerData> (this));
-	SInterface<ITraitManager> (LG)->Listen (on_trait_change, this);
+	cached_interface<ITraitManager> ()->Listen (on_trait_change, this);
 }
 
 ParameterCacheImpl::~ParameterCacheImpl ()
@@ -359,10 +360,37 @@ ParameterCacheImpl::dump (Monolog& log)
 	log << std::flush;
 }
 
+const String*
+ParameterCacheImpl::get_debug_param (const Object& object)
+{
+	if (!debug_params_indexed)
+		index_debug_params ();
+
+	// Almost no design note has a debug parameter, so usually this ends
+	// here without consulting the object's ancestry.
+	if (debug_params.empty ())
+		return nullptr;
+
+	auto param = debug_params.find (object);
+	if (param != debug_params.end ())
+		return &param->second;
+
+	for (auto& ancestor : object.get_ancestors ())
+	{
+		param = debug_params.find (ancestor);
+		if (param != debug_params.end ())
+			return &param->second;
+	}
+
+	return nullptr;
+}
+
 void
 ParameterCacheImpl::reset ()
 {
 	data.clear ();
+	debug_params.clear ();
+	debug_params_indexed = false;
 }
 
 STDMETHODIMP_ (void)
@@ -375,6 +403,9 @@ ParameterCacheImpl::on_dn_change (sPropertyListenMsg* message,
 	Object object = Object (message->iObjId);
 	auto self = reinterpret_cast<ParameterCacheImpl*> (_self);
 
+	if (self->debug_params_indexed)
+		self->index_debug_param (object);
+
 	auto dn_iter = self->data.find (object);
 	if (dn_iter == self->data.end ()) return;
 	DesignNote& dn = dn_iter->second;
@@ -460,6 +491,41 @@ ParameterCacheImpl::unwatch_ancestor (const Object& object)
 		data.erase (object);
 }
 
+void
+ParameterCacheImpl::index_debug_params ()
+{
+	debug_params.clear ();
+
+	sPropertyObjIter iter;
+	int number = 0;
+	dn_prop->IterStart (&iter);
+	while (dn_prop->IterNext (&iter, &number))
+		index_debug_param (Object (number));
+	dn_prop->IterStop (&iter);
+
+	debug_params_indexed = true;
+}
+
+void
+ParameterCacheImpl::index_debug_param (const Object& object)
+{
+	debug_params.erase (object);
+
+	const char* dn = nullptr;
+	if (dn_prop->IsSimplyRelevant (object.number))
+		dn_prop->GetSimple (object.number, &dn);
+
+	// Only parse design notes that could possibly have the parameter.
+	if (!dn || CIString (dn).find ("debug") == CIString::npos)
+		return;
+
+	DesignNote::RawValues raw_values;
+	DesignNoteReader (dn, raw_values);
+	auto debug = raw_values.find ("debug");
+	if (debug != raw_values.end ())
+		debug_params.emplace (object, debug->second);
+}
+
 void
 ParameterCacheImpl::read_dn (const Object& object)
 {
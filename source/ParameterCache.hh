@@ -52,6 +52,10 @@ public:
 		const ParameterBase&) = 0;
 
 	virtual void dump (Monolog& log) = 0;
+
+	// The "debug" parameter of the object or its nearest ancestor. This
+	// is answered from an index of all design notes, without watching.
+	virtual const String* get_debug_param (const Object& object) = 0;
 };
 
 
@@ -128,6 +132,8 @@ public:
 
 	virtual void dump (Monolog& log);
 
+	virtual const String* get_debug_param (const Object& object);
+
 private:
 	friend class OSL;
 	ParameterCacheImpl ();
@@ -152,6 +158,13 @@ private:
 	Data data;
 
 	Object current;
+
+	void index_debug_params ();
+	void index_debug_param (const Object&);
+
+	typedef std::map<Object, String> DebugParams;
+	DebugParams debug_params;
+	bool debug_params_indexed;
 };
 
 
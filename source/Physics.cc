@@ -114,7 +114,7 @@ bool
 Physical::is_physical () const
 {
 #ifdef IS_THIEF2
-	return SService<IPhysSrv> (LG)->HasPhysics (number);
+	return cached_service<IPhysSrv> ()->HasPhysics (number);
 #else
 	return physics_type.exists ();
 #endif
@@ -124,7 +124,7 @@ bool
 Physical::remove_physics ()
 {
 #ifdef IS_THIEF2
-	return SService<IPhysSrv> (LG)->DeregisterModel (number) == S_OK;
+	return cached_service<IPhysSrv> ()->DeregisterModel (number) == S_OK;
 #else
 	return ObjectProperty ("PhysType", *this).remove ();
 #endif
@@ -133,7 +133,7 @@ Physical::remove_physics ()
 bool
 Physical::is_climbable () const
 {
-	return SService<IPhysSrv> (LG)->IsRope (number);
+	return cached_service<IPhysSrv> ()->IsRope (number);
 }
 
 #ifdef IS_THIEF2
@@ -141,13 +141,13 @@ Physical::is_climbable () const
 bool
 Physical::is_position_valid () const
 {
-	return SService<IPhysSrv> (LG)->ValidPos (number);
+	return cached_service<IPhysSrv> ()->ValidPos (number);
 }
 
 bool
 Physical::wake_up_physics ()
 {
-	return SService<IPhysSrv> (LG)->Activate (number) == S_OK;
+	return cached_service<IPhysSrv> ()->Activate (number) == S_OK;
 }
 
 #endif // IS_THIEF2
@@ -155,13 +155,13 @@ Physical::wake_up_physics ()
 void
 Physical::subscribe_physics (Messages messages)
 {
-	SService<IPhysSrv> (LG)->SubscribeMsg (number, messages);
+	cached_service<IPhysSrv> ()->SubscribeMsg (number, messages);
 }
 
 void
 Physical::unsubscribe_physics (Messages messages)
 {
-	SService<IPhysSrv> (LG)->UnsubscribeMsg (number, messages);
+	cached_service<IPhysSrv> ()->UnsubscribeMsg (number, messages);
 }
 
 
@@ -273,7 +273,8 @@ MESSAGE_WRAPPER_IMPL (MovingTerrainMessage, "MovingTerrainWaypoint"),
 {}
 
 MovingTerrainMessage::MovingTerrainMessage (const Object& _waypoint)
-	: Message (new sMovingTerrainMsg ()), waypoint (_waypoint)
+	: Message (new PooledMessage<sMovingTerrainMsg> ()),
+	  waypoint (_waypoint)
 {
 	message->message = "MovingTerrainWaypoint";
 	MESSAGE_AS (sMovingTerrainMsg)->waypoint = waypoint.number;
@@ -288,7 +289,8 @@ MESSAGE_WRAPPER_IMPL (WaypointMessage, "WaypointReached"),
 {}
 
 WaypointMessage::WaypointMessage (const Object& _moving_terrain)
-	: Message (new sWaypointMsg ()), moving_terrain (_moving_terrain)
+	: Message (new PooledMessage<sWaypointMsg> ()),
+	  moving_terrain (_moving_terrain)
 {
 	message->message = "WaypointReached";
 	MESSAGE_AS (sWaypointMsg)->moving_terrain = moving_terrain.number;
@@ -392,7 +394,8 @@ Projectile::launch (const Object& archetype, const Object& launcher,
 	float velocity_mult, const Vector& velocity_add, unsigned flags)
 {
 	LGObject projectile;
-	SService<IPhysSrv> (LG)->LaunchProjectile (projectile, launcher.number,
+	cached_service<IPhysSrv> ()->LaunchProjectile
+		(projectile, launcher.number,
 		archetype.number, velocity_mult, flags, LGVector (velocity_add));
 	return projectile;
 }
@@ -73,7 +73,8 @@ Player::Player ()
 bool
 Player::is_in_inventory (const Object& object) const
 {
-	return SInterface<IContainSys> (LG)->Contains (number, object.number);
+	return cached_interface<IContainSys> ()->Contains (number,
+		object.number);
 }
 
 Container::Contents
@@ -85,31 +86,31 @@ Player::get_inventory () const
 void
 Player::add_to_inventory (const Object& object)
 {
-	SInterface<IInventory> (LG)->Add (object.number);
+	cached_interface<IInventory> ()->Add (object.number);
 }
 
 void
 Player::remove_from_inventory (const Object& object)
 {
-	SInterface<IInventory> (LG)->Remove (object.number);
+	cached_interface<IInventory> ()->Remove (object.number);
 }
 
 Interactive
 Player::get_selected_item () const
 {
-	return Object (SInterface<IInventory> (LG)->Selection (kInvItem));
+	return Object (cached_interface<IInventory> ()->Selection (kInvItem));
 }
 
 bool
 Player::is_wielding_junk () const
 {
-	return SInterface<IInventory> (LG)->WieldingJunk ();
+	return cached_interface<IInventory> ()->WieldingJunk ();
 }
 
 void
 Player::select_item (const Object& item)
 {
-	SInterface<IInventory> (LG)->Select (item.number);
+	cached_interface<IInventory> ()->Select (item.number);
 }
 
 void
@@ -127,14 +128,14 @@ Player::select_newest_item ()
 void
 Player::cycle_item_selection (Cycle direction)
 {
-	SInterface<IInventory> (LG)->CycleSelection (kInvItem,
+	cached_interface<IInventory> ()->CycleSelection (kInvItem,
 		eCycleDirection (direction));
 }
 
 void
 Player::clear_item ()
 {
-	SInterface<IInventory> (LG)->ClearSelection (kInvItem);
+	cached_interface<IInventory> ()->ClearSelection (kInvItem);
 }
 
 void
@@ -193,42 +194,42 @@ Player::has_touched (const Object& object) const
 Weapon
 Player::get_selected_weapon () const
 {
-	return Object (SInterface<IInventory> (LG)->Selection (kInvWeapon));
+	return Object (cached_interface<IInventory> ()->Selection (kInvWeapon));
 }
 
 bool
 Player::is_bow_selected () const
 {
-	return SService<IBowSrv> (LG)->IsEquipped ();
+	return cached_service<IBowSrv> ()->IsEquipped ();
 }
 
 void
 Player::select_weapon (const Weapon& weapon)
 {
-	SInterface<IInventory> (LG)->Select (weapon.number);
+	cached_interface<IInventory> ()->Select (weapon.number);
 }
 
 void
 Player::cycle_weapon_selection (Cycle direction)
 {
-	SInterface<IInventory> (LG)->CycleSelection (kInvWeapon,
+	cached_interface<IInventory> ()->CycleSelection (kInvWeapon,
 		eCycleDirection (direction));
 }
 
 void
 Player::clear_weapon ()
 {
-	SInterface<IInventory> (LG)->ClearSelection (kInvWeapon);
+	cached_interface<IInventory> ()->ClearSelection (kInvWeapon);
 }
 
 bool
 Player::start_attack ()
 {
 	Weapon weapon = get_selected_weapon ();
-	if (SService<IBowSrv> (LG)->IsEquipped ())
-		return SService<IBowSrv> (LG)->StartAttack ();
+	if (cached_service<IBowSrv> ()->IsEquipped ())
+		return cached_service<IBowSrv> ()->StartAttack ();
 	else
-		return SService<IWeaponSrv> (LG)->StartAttack
+		return cached_service<IWeaponSrv> ()->StartAttack
 			(number, weapon.number);
 }
 
@@ -236,10 +237,10 @@ bool
 Player::finish_attack ()
 {
 	Weapon weapon = get_selected_weapon ();
-	if (SService<IBowSrv> (LG)->IsEquipped ())
-		return SService<IBowSrv> (LG)->FinishAttack ();
+	if (cached_service<IBowSrv> ()->IsEquipped ())
+		return cached_service<IBowSrv> ()->FinishAttack ();
 	else
-		return SService<IWeaponSrv> (LG)->FinishAttack
+		return cached_service<IWeaponSrv> ()->FinishAttack
 			(number, weapon.number);
 }
 
@@ -247,8 +248,8 @@ bool
 Player::abort_attack ()
 {
 	// "Weapon" (sword/blackjack) attacks cannot be aborted.
-	return SService<IBowSrv> (LG)->IsEquipped () &&
-		SService<IBowSrv> (LG)->AbortAttack ();
+	return cached_service<IBowSrv> ()->IsEquipped () &&
+		cached_service<IBowSrv> ()->AbortAttack ();
 }
 
 
@@ -261,7 +262,7 @@ Physical
 Player::get_climbing_object () const
 {
 	LGObject object;
-	SService<IPhysSrv> (LG)->GetClimbingObject (number, object);
+	cached_service<IPhysSrv> ()->GetClimbingObject (number, object);
 	return object;
 }
 
@@ -269,7 +270,7 @@ void
 Player::nudge_physics (int submodel, const Vector& _by)
 {
 	LGVector by (_by);
-	SService<IPhysSrv> (LG)->PlayerMotionSetOffset (submodel, by);
+	cached_service<IPhysSrv> ()->PlayerMotionSetOffset (submodel, by);
 }
 
 #endif // IS_THIEF2
@@ -283,14 +284,14 @@ Player::unstick ()
 void
 Player::add_speed_control (const String& name, float factor)
 {
-	SService<IDarkInvSrv> (LG)->AddSpeedControl
+	cached_service<IDarkInvSrv> ()->AddSpeedControl
 		(name.data (), factor, factor);
 }
 
 void
 Player::remove_speed_control (const String& name)
 {
-	SService<IDarkInvSrv> (LG)->RemoveSpeedControl (name.data ());
+	cached_service<IDarkInvSrv> ()->RemoveSpeedControl (name.data ());
 }
 
 
@@ -300,28 +301,28 @@ Player::remove_speed_control (const String& name)
 bool
 Player::show_arm ()
 {
-	return SService<IPlayerLimbsSrv> (LG)->Equip
+	return cached_service<IPlayerLimbsSrv> ()->Equip
 		(get_selected_item ().number);
 }
 
 bool
 Player::start_arm_use ()
 {
-	return SService<IPlayerLimbsSrv> (LG)->StartUse
+	return cached_service<IPlayerLimbsSrv> ()->StartUse
 		(get_selected_item ().number);
 }
 
 bool
 Player::finish_arm_use ()
 {
-	return SService<IPlayerLimbsSrv> (LG)->FinishUse
+	return cached_service<IPlayerLimbsSrv> ()->FinishUse
 		(get_selected_item ().number);
 }
 
 bool
 Player::hide_arm ()
 {
-	return SService<IPlayerLimbsSrv> (LG)->UnEquip
+	return cached_service<IPlayerLimbsSrv> ()->UnEquip
 		(get_selected_item ().number);
 }
 
@@ -332,21 +333,21 @@ Player::hide_arm ()
 bool
 Player::drop_dead ()
 {
-	return SService<IDarkGameSrv> (LG)->KillPlayer () == S_OK;
+	return cached_service<IDarkGameSrv> ()->KillPlayer () == S_OK;
 }
 
 void
 Player::enable_world_focus ()
 {
 	// Controlling the other three capabilities does not have any effect.
-	SService<IDarkInvSrv> (LG)->CapabilityControl
+	cached_service<IDarkInvSrv> ()->CapabilityControl
 		(kDrkInvCapWorldFocus, kDrkInvControlOn);
 }
 
 void
 Player::disable_world_focus ()
 {
-	SService<IDarkInvSrv> (LG)->CapabilityControl
+	cached_service<IDarkInvSrv> ()->CapabilityControl
 		(kDrkInvCapWorldFocus, kDrkInvControlOff);
 }
 
@@ -363,7 +364,7 @@ Camera::get ()
 		throw std::runtime_error ("Camera::get"
 			" is not implemented before engine version 1.22.");
 	LGObject camera;
-	SService<ICameraSrv> (LG)->GetCameraParent (camera);
+	cached_service<ICameraSrv> ()->GetCameraParent (camera);
 	return camera;
 }
 
@@ -375,7 +376,7 @@ Camera::is_remote ()
 			" is not implemented before engine version 1.22.");
 
 	LGBool remote;
-	SService<ICameraSrv> (LG)->IsRemote (remote);
+	cached_service<ICameraSrv> ()->IsRemote (remote);
 	return remote;
 }
 
@@ -383,18 +384,19 @@ void
 Camera::attach (const Object& to, bool freelook)
 {
 	if (freelook)
-		SService<ICameraSrv> (LG)->DynamicAttach (to.number);
+		cached_service<ICameraSrv> ()->DynamicAttach (to.number);
 	else
-		SService<ICameraSrv> (LG)->StaticAttach (to.number);
+		cached_service<ICameraSrv> ()->StaticAttach (to.number);
 }
 
 bool
 Camera::detach (const Object& from)
 {
 	if (from == Object::ANY)
-		return SService<ICameraSrv> (LG)->ForceCameraReturn () == S_OK;
+		return cached_service<ICameraSrv> ()->ForceCameraReturn
+			() == S_OK;
 	else
-		return SService<ICameraSrv> (LG)->CameraReturn
+		return cached_service<ICameraSrv> ()->CameraReturn
 			(from.number) == S_OK;
 }
 
@@ -405,7 +407,7 @@ Camera::get_location ()
 		throw std::runtime_error ("Camera::get_location"
 			" is not implemented before engine version 1.22.");
 	LGVector location;
-	SService<ICameraSrv> (LG)->GetPosition (location);
+	cached_service<ICameraSrv> ()->GetPosition (location);
 	return location;
 }
 
@@ -416,7 +418,7 @@ Camera::get_rotation ()
 		throw std::runtime_error ("Camera::get_rotation"
 			" is not implemented before engine version 1.22.");
 	LGVector rotation;
-	SService<ICameraSrv> (LG)->GetFacing (rotation);
+	cached_service<ICameraSrv> ()->GetFacing (rotation);
 	return rotation;
 }
 
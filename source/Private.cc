@@ -37,7 +37,7 @@ g_pMalloc = nullptr;
 void*
 operator new (std::size_t size)
 {
-	void* ptr = Thief::alloc.alloc (size);
+	void* ptr = Thief::alloc.new_block (size);
 	if (!ptr) throw std::bad_alloc ();
 	return ptr;
 }
@@ -45,7 +45,7 @@ operator new (std::size_t size)
 void*
 operator new [] (std::size_t size)
 {
-	void* ptr = Thief::alloc.alloc (size);
+	void* ptr = Thief::alloc.new_block (size);
 	if (!ptr) throw std::bad_alloc ();
 	return ptr;
 }
@@ -53,37 +53,37 @@ operator new [] (std::size_t size)
 void*
 operator new (std::size_t size, const std::nothrow_t&) noexcept
 {
-	return Thief::alloc.alloc (size);
+	return Thief::alloc.new_block (size);
 }
 
 void*
 operator new [] (std::size_t size, const std::nothrow_t&) noexcept
 {
-	return Thief::alloc.alloc (size);
+	return Thief::alloc.new_block (size);
 }
 
 void
 operator delete (void* ptr) noexcept
 {
-	Thief::alloc.free (ptr);
+	Thief::alloc.delete_block (ptr);
 }
 
 void
 operator delete [] (void* ptr) noexcept
 {
-	Thief::alloc.free (ptr);
+	Thief::alloc.delete_block (ptr);
 }
 
 void
 operator delete (void* ptr, const std::nothrow_t&) noexcept
 {
-	Thief::alloc.free (ptr);
+	Thief::alloc.delete_block (ptr);
 }
 
 void
 operator delete [] (void* ptr, const std::nothrow_t&) noexcept
 {
-	Thief::alloc.free (ptr);
+	Thief::alloc.delete_block (ptr);
 }
 
 
@@ -102,7 +102,17 @@ Allocator::Allocator()
 #ifdef DEBUG
 	, dbmalloc (nullptr), module_name (nullptr)
 #endif
-{}
+{
+	for (size_t pool = 0u; pool < POOLS; ++pool)
+	{
+		pools [pool].block_size = (pool < POOL_CLASSES)
+			? (1u << (POOL_MIN_SHIFT + pool)) : 0u;
+		pools [pool].live_blocks = pools [pool].live_bytes =
+			pools [pool].peak_bytes = 0u;
+		pools [pool].allocations = 0ul;
+		pools [pool].free_list = nullptr;
+	}
+}
 
 Allocator::~Allocator()
 {
@@ -184,6 +194,180 @@ Allocator::free (void* ptr)
 		malloc->Free (ptr);
 }
 
+// Slabs are carved into slots for a single pool and never returned.
+#define POOL_SLAB_SIZE 16384u
+
+void*
+Allocator::new_block (size_t size)
+{
+	// Debug builds use the same pools and headers as release builds, since
+	// the blocks may cross into a module built the other way. Large blocks
+	// bypass the debug heap for the same reason; see dump_pools for leaks.
+	assert (malloc != nullptr);
+	size_t _pool = get_pool (size);
+	Pool& pool = pools [_pool];
+
+	BlockHeader* header;
+	if (_pool < POOL_CLASSES)
+	{
+		if (!pool.free_list && !refill (_pool))
+			return nullptr;
+		header = reinterpret_cast<BlockHeader*> (pool.free_list);
+		pool.free_list = pool.free_list->next;
+	}
+	else
+	{
+		header = static_cast<BlockHeader*>
+			(malloc->Alloc (sizeof (BlockHeader) + size));
+		if (!header) return nullptr;
+	}
+
+	header->pool = _pool;
+	header->size = size;
+	header->owner = this;
+	header->magic = BLOCK_MAGIC;
+
+	++pool.live_blocks;
+	++pool.allocations;
+	pool.live_bytes += size;
+	pool.peak_bytes = std::max (pool.peak_bytes, pool.live_bytes);
+
+	return header + 1;
+}
+
+void
+Allocator::delete_block (void* ptr)
+{
+	if (!ptr) return;
+
+	BlockHeader* header = static_cast<BlockHeader*> (ptr) - 1;
+	if (header->magic != BLOCK_MAGIC || header->pool >= POOLS)
+	{
+		// Not a block from new_block (or already deleted). Leaking it is
+		// safer than returning an unknown block to any heap.
+		assert (!"delete_block given a block without a valid header");
+		return;
+	}
+	header->magic = 0u;
+
+	size_t _pool = header->pool;
+	Pool& pool = pools [_pool];
+
+	// Blocks created by another module's allocator are accounted there.
+	// Their slots come from never-returned slabs on the shared engine heap
+	// and are the same size as ours, so they can join this free list.
+	if (header->owner == this)
+	{
+		--pool.live_blocks;
+		pool.live_bytes -= header->size;
+	}
+
+	if (_pool < POOL_CLASSES)
+	{
+		FreeSlot* slot = reinterpret_cast<FreeSlot*> (header);
+		slot->next = pool.free_list;
+		pool.free_list = slot;
+	}
+	else
+		malloc->Free (header);
+}
+
+const Allocator::PoolStats&
+Allocator::get_pool_stats (size_t pool) const
+{
+	if (pool >= POOLS)
+		throw std::out_of_range ("invalid allocator pool");
+	return pools [pool];
+}
+
+void
+Allocator::dump_pools (std::ostream& out) const
+{
+	static const boost::format ROW ("%|6| %|8| %|10| %|10| %|12|");
+	out << "Allocator pools:" << std::endl
+		<< boost::format (ROW) % "block" % "live" % "live bytes"
+			% "peak bytes" % "allocations" << std::endl;
+	for (auto& pool : pools)
+		out << boost::format (ROW)
+			% (pool.block_size ? std::to_string (pool.block_size)
+				: String ("large"))
+			% pool.live_blocks % pool.live_bytes % pool.peak_bytes
+			% pool.allocations << std::endl;
+}
+
+size_t
+Allocator::get_pool (size_t size)
+{
+	size_t pool = 0u;
+	while (pool < POOL_CLASSES && size > (1u << (POOL_MIN_SHIFT + pool)))
+		++pool;
+	return pool;
+}
+
+bool
+Allocator::refill (size_t _pool)
+{
+	Pool& pool = pools [_pool];
+	size_t slot_size = sizeof (BlockHeader) + pool.block_size;
+
+	char* slab = static_cast<char*> (alloc (POOL_SLAB_SIZE));
+	if (!slab) return false;
+
+	for (size_t offset = 0u; offset + slot_size <= POOL_SLAB_SIZE;
+	     offset += slot_size)
+	{
+		FreeSlot* slot = reinterpret_cast<FreeSlot*> (slab + offset);
+		slot->next = pool.free_list;
+		pool.free_list = slot;
+	}
+	return true;
+}
+
+
+
+// ServiceCache
+
+ServiceCache::Releaser
+ServiceCache::releasers [MAX_CACHED] = {};
+
+size_t
+ServiceCache::cached_count = 0u;
+
+void
+ServiceCache::attach ()
+{
+	try
+	{
+		cached_service<IObjectSrv> ();
+		cached_service<IPropertySrv> ();
+		cached_service<IQuestSrv> ();
+		cached_service<IEngineSrv> ();
+		cached_service<IVersionSrv> ();
+		cached_service<IDarkOverlaySrv> ();
+		cached_interface<ILinkManager> ();
+		cached_interface<ITraitManager> ();
+		cached_interface<IPropertyManager> ();
+		cached_interface<IContainSys> ();
+		cached_interface<ISimManager> ();
+	}
+	catch (no_interface&) {} // The rest will be obtained on first use.
+}
+
+void
+ServiceCache::detach ()
+{
+	while (cached_count > 0u)
+		releasers [--cached_count] ();
+}
+
+void
+ServiceCache::retain (Releaser releaser)
+{
+	if (cached_count < MAX_CACHED)
+		releasers [cached_count++] = releaser;
+	// Otherwise the reference is simply kept until the process exits.
+}
+
 
 
 // XYZColor
@@ -333,5 +517,28 @@ ConversationMessageImpl::GetName () const
 
 
 
+// Length-prefixed strings for state serialized into the script data store
+
+void
+write_string (std::ostream& out, const String& value)
+{
+	out << value.size () << ':' << value;
+}
+
+String
+read_string (std::istream& in)
+{
+	size_t size = 0;
+	char colon = '\0';
+	in >> size >> colon;
+	if (!in || colon != ':')
+		throw std::runtime_error ("malformed string");
+	String value (size, '\0');
+	in.read (&value [0], size);
+	return value;
+}
+
+
+
 } // namespace Thief
 
@@ -46,22 +46,179 @@ public:
 
 	void attach (IMalloc* allocator, const char* module_name);
 
+	// Blocks on the engine heap, which may be shared with the engine.
 	void* alloc (size_t size);
 	void* realloc (void* ptr, size_t size);
 	void free (void* ptr);
 
+	// Blocks for operator new and delete. Small blocks are recycled through
+	// per-size free lists; larger ones come from the engine heap. The block
+	// format is the same in every build, since blocks (such as shared COW
+	// strings) may be deleted by a different module than the one that
+	// created them.
+	void* new_block (size_t size);
+	void delete_block (void* ptr);
+
+	// The smallest pooled block is 16 bytes; each pool doubles the size.
+	enum { POOL_MIN_SHIFT = 4, POOL_CLASSES = 5, POOLS = POOL_CLASSES + 1 };
+
+	struct PoolStats
+	{
+		size_t block_size; // zero for blocks from the engine heap
+		size_t live_blocks, live_bytes, peak_bytes;
+		unsigned long allocations;
+	};
+
+	// The last pool counts the blocks too large for the others.
+	const PoolStats& get_pool_stats (size_t pool) const;
+	void dump_pools (std::ostream&) const;
+
 private:
 	IMalloc* malloc;
 #ifdef DEBUG
 	IDebugMalloc* dbmalloc;
 	char* module_name;
 #endif
+
+	// Sized so that blocks keep the 16-byte alignment of malloc.
+	struct BlockHeader
+	{
+		unsigned pool;
+		unsigned size;
+		const Allocator* owner;
+		unsigned magic;
+	};
+	enum { BLOCK_MAGIC = 0x544C4221u }; // "TLB!"
+	static_assert (sizeof (BlockHeader) == 16u,
+		"allocator block headers must preserve 16-byte alignment");
+
+	struct FreeSlot
+	{
+		FreeSlot* next;
+	};
+
+	struct Pool : PoolStats
+	{
+		FreeSlot* free_list;
+	};
+
+	Pool pools [POOLS];
+
+	static size_t get_pool (size_t size);
+	bool refill (size_t pool);
 };
 
 extern Allocator alloc;
 
 
 
+// ServiceCache: engine services and interfaces obtained once per module
+
+class ServiceCache
+{
+public:
+	// Obtains the services that ThiefLib uses most. Any others are obtained
+	// on first use by cached_service() or cached_interface().
+	static void attach ();
+
+	// Releases every cached service and interface.
+	static void detach ();
+
+	typedef void (*Releaser) ();
+	static void retain (Releaser releaser);
+
+private:
+	enum { MAX_CACHED = 64 };
+	static Releaser releasers [MAX_CACHED];
+	static size_t cached_count;
+};
+
+template <typename Type>
+struct CachedPointer
+{
+	static Type* pointer;
+
+	static void release ()
+	{
+		if (pointer) pointer->Release ();
+		pointer = nullptr;
+	}
+};
+
+template <typename Type>
+Type* CachedPointer<Type>::pointer = nullptr;
+
+// Replaces a temporary SService<Service> (LG).
+template <typename Service>
+inline Service*
+cached_service ()
+{
+	Service*& pointer = CachedPointer<Service>::pointer;
+	if (!pointer)
+	{
+		SService<Service> service (LG); // throws no_interface
+		pointer = service;
+		pointer->AddRef ();
+		ServiceCache::retain (&CachedPointer<Service>::release);
+	}
+	return pointer;
+}
+
+// Replaces a temporary SInterface<Interface> (LG).
+template <typename Interface>
+inline Interface*
+cached_interface ()
+{
+	Interface*& pointer = CachedPointer<Interface>::pointer;
+	if (!pointer)
+	{
+		SInterface<Interface> _interface (LG); // throws no_interface
+		pointer = _interface;
+		pointer->AddRef ();
+		ServiceCache::retain (&CachedPointer<Interface>::release);
+	}
+	return pointer;
+}
+
+
+
+// ExistenceCache: Object::exists results memoized within a script dispatch
+
+class ExistenceCache
+{
+public:
+	// Scopes the cache to the outermost dispatch in progress.
+	class Dispatch
+	{
+	public:
+		Dispatch ();
+		~Dispatch ();
+	};
+
+	static bool lookup (Object::Number number, bool& exists);
+	static void store (Object::Number number, bool exists);
+
+	// For objects created or destroyed by this module.
+	static void invalidate ();
+
+private:
+	enum { SIZE = 64 }; // direct-mapped by object number
+
+	struct Entry
+	{
+		Object::Number number;
+		bool exists;
+		unsigned long dispatch, generation;
+	};
+
+	static Entry entries [SIZE];
+	static unsigned depth;
+	static unsigned long dispatch;
+	static const unsigned long* generation; // owned by the OSL
+};
+
+
+
 // XYZColor: intermediate for CIE color space conversion
 
 struct XYZColor
@@ -207,6 +364,63 @@ struct ConversationMessageImpl : public sScrMsg
 
 
 
+// PooledMessage: message structure recycled through a per-type free list
+// when its reference count drops to zero and it is deleted
+
+template <typename LGType>
+struct PooledMessage : public LGType
+{
+	static void* operator new (size_t size)
+	{
+		if (size == sizeof (PooledMessage) && free_list)
+		{
+			FreeBlock* block = free_list;
+			free_list = block->next;
+			--free_count;
+			return block;
+		}
+		return ::operator new (size);
+	}
+
+	static void operator delete (void* ptr, size_t size)
+	{
+		if (ptr && size == sizeof (PooledMessage) &&
+		    free_count < POOL_LIMIT)
+		{
+			FreeBlock* block = static_cast<FreeBlock*> (ptr);
+			block->next = free_list;
+			free_list = block;
+			++free_count;
+		}
+		else
+			::operator delete (ptr);
+	}
+
+private:
+	enum { POOL_LIMIT = 32 };
+
+	struct FreeBlock { FreeBlock* next; };
+	static FreeBlock* free_list;
+	static size_t free_count;
+};
+
+template <typename LGType>
+typename PooledMessage<LGType>::FreeBlock*
+PooledMessage<LGType>::free_list = nullptr;
+
+template <typename LGType>
+size_t
+PooledMessage<LGType>::free_count = 0u;
+
+
+
+// Length-prefixed strings for state serialized into the script data store
+
+void write_string (std::ostream& out, const String& value);
+String read_string (std::istream& in);
+
+
+
 // Field proxy convenience macros
 
 #define PROXY_CONFIG_(Class, Member, Major, Minor, Type, Default, Detail, Getter, Setter) \
@@ -359,6 +573,20 @@ FlavorName##Link::FlavorName##Link (Number _number) \
 // Message subclass convenience macros
 
 #define MESSAGE_WRAPPER_IMPL_(Type, Tests) \
+bool \
+Type::matches (sScrMsg* _message) \
+{ \
+	return _message && (Tests); \
+} \
+\
+boost::optional<Type> \
+Type::try_wrap (sScrMsg* _message, sMultiParm* _reply) \
+{ \
+	if (!matches (_message)) return boost::none; \
+	try { return Type (_message, _reply); } \
+	catch (MessageWrapError&) { return boost::none; } \
+} \
+\
 Type::Type (sScrMsg* _message, sMultiParm* _reply) \
 	: Message (_message, _reply, (Tests), #Type)
 
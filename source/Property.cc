@@ -50,7 +50,7 @@ Property::~Property ()
 
 Property::Property (const String& name)
 	: iface (static_cast<IGenericProperty*>
-		(SInterface<IPropertyManager> (LG)->GetPropertyNamed
+		(cached_interface<IPropertyManager> ()->GetPropertyNamed
 			(name.data ())))
 {
 	if (iface)
@@ -62,7 +62,8 @@ Property::Property (const String& name)
 
 Property::Property (const char* name)
 	: iface (static_cast<IGenericProperty*>
-		(SInterface<IPropertyManager> (LG)->GetPropertyNamed (name)))
+		(cached_interface<IPropertyManager> ()->GetPropertyNamed
+			(name)))
 {
 	if (iface)
 		iface->AddRef ();
@@ -80,7 +81,7 @@ Property::get_name () const
 
 Property::Property (Number number)
 	: iface (static_cast<IGenericProperty*>
-		(SInterface<IPropertyManager> (LG)->GetProperty (number)))
+		(cached_interface<IPropertyManager> ()->GetProperty (number)))
 {
 	if (iface) iface->AddRef ();
 }
@@ -104,7 +105,7 @@ MESSAGE_WRAPPER_IMPL (PropertyMessage, "PropertyChange"),
 
 PropertyMessage::PropertyMessage (Event _event, bool _inherited,
 		const Property& _property, const Object& _object)
-	: Message (new PropertyMessageImpl ()), event (_event),
+	: Message (new PooledMessage<PropertyMessageImpl> ()), event (_event),
 	  inherited (_inherited), property (_property), object (_object)
 {
 	message->message = "PropertyChange";
@@ -191,7 +192,7 @@ void
 ObjectProperty::subscribe (const Property& property, const Object& object,
 	const Object& host)
 {
-	if (!SService<IOSLService> (LG)->subscribe_property
+	if (!cached_service<IOSLService> ()->subscribe_property
 			(property, object, host))
 		throw std::runtime_error ("could not subscribe to property");
 }
@@ -200,7 +201,7 @@ bool
 ObjectProperty::unsubscribe (const Property& property, const Object& object,
 	const Object& host)
 {
-	return SService<IOSLService> (LG)->unsubscribe_property
+	return cached_service<IOSLService> ()->unsubscribe_property
 		(property, object, host);
 }
 
@@ -212,7 +213,7 @@ ObjectProperty::_get (LGMultiBase& value) const
 	if (!property.iface)
 		throw MissingResource (MissingResource::PROPERTY, "(null)",
 			Object::NONE);
-	SService<IPropertySrv> (LG)->Get (value, object.number,
+	cached_service<IPropertySrv> ()->Get (value, object.number,
 		property.iface->Describe ()->szName, nullptr);
 	if (value.empty ())
 		throw MissingResource (MissingResource::PROPERTY,
@@ -229,7 +230,7 @@ ObjectProperty::_set (const LGMultiBase& value)
 			Object::NONE);
 	if (!exists (false))
 		instantiate ();
-	if (SService<IPropertySrv> (LG)->Set (object.number,
+	if (cached_service<IPropertySrv> ()->Set (object.number,
 	    property.iface->Describe ()->szName, nullptr, value) != S_OK)
 		throw std::runtime_error ("could not set property");
 }
@@ -242,7 +243,7 @@ ObjectProperty::_get_field (const char* field, LGMultiBase& value) const
 	if (!property.iface)
 		throw MissingResource (MissingResource::PROPERTY, "(null)",
 			Object::NONE);
-	SService<IPropertySrv> (LG)->Get (value, object.number,
+	cached_service<IPropertySrv> ()->Get (value, object.number,
 		property.iface->Describe ()->szName, field);
 	if (value.empty ())
 		throw MissingResource (MissingResource::PROPERTY,
@@ -267,7 +268,7 @@ ObjectProperty::_set_field (const char* field, const LGMultiBase& value,
 			throw MissingResource (MissingResource::PROPERTY,
 				property.get_name (), object);
 	}
-	if (SService<IPropertySrv> (LG)->Set (object.number,
+	if (cached_service<IPropertySrv> ()->Set (object.number,
 	    property.iface->Describe ()->szName, field, value) != S_OK)
 		throw std::runtime_error ("could not set property field");
 }
@@ -38,7 +38,7 @@ QuestVar::QuestVar (const String& _name, Scope _scope)
 bool
 QuestVar::exists () const
 {
-	return SService<IQuestSrv> (LG)->Exists (name.data ());
+	return cached_service<IQuestSrv> ()->Exists (name.data ());
 }
 
 int
@@ -47,33 +47,34 @@ QuestVar::get (int default_value) const
 	if (default_value != 0 && !exists ())
 		return default_value;
 	else
-		return SService<IQuestSrv> (LG)->Get (name.data ());
+		return cached_service<IQuestSrv> ()->Get (name.data ());
 }
 
 void
 QuestVar::set (int value)
 {
-	SService<IQuestSrv> (LG)->Set
+	cached_service<IQuestSrv> ()->Set
 		(name.data (), value, eQuestDataType (scope));
 }
 
 void
 QuestVar::clear ()
 {
-	SService<IQuestSrv> (LG)->Delete (name.data ());
+	cached_service<IQuestSrv> ()->Delete (name.data ());
 }
 
 void
 QuestVar::subscribe (const String& name, const Object& host, Scope scope)
 {
-	SService<IQuestSrv> (LG)->SubscribeMsg
+	cached_service<IQuestSrv> ()->SubscribeMsg
 		(host.number, name.data (), eQuestDataType (scope));
 }
 
 void
 QuestVar::unsubscribe (const String& name, const Object& host)
 {
-	SService<IQuestSrv> (LG)->UnsubscribeMsg (host.number, name.data ());
+	cached_service<IQuestSrv> ()->UnsubscribeMsg (host.number,
+		name.data ());
 }
 
 
@@ -89,7 +90,8 @@ MESSAGE_WRAPPER_IMPL (QuestMessage, "QuestChange"),
 
 QuestMessage::QuestMessage (const char* _quest_var, int _new_value,
 		int _old_value)
-	: Message (new sQuestMsg ()), quest_var (_quest_var ? _quest_var : ""),
+	: Message (new PooledMessage<sQuestMsg> ()),
+	  quest_var (_quest_var ? _quest_var : ""),
 	  new_value (_new_value), old_value (_old_value)
 {
 	message->message = "QuestChange";
@@ -403,7 +405,6 @@ THIEF_ENUM_CODING (ObjectiveMessage::Field, CODE, CODE,
 
 MESSAGE_WRAPPER_IMPL_ (ObjectiveMessage,
 	MESSAGE_NAME_TEST ("QuestChange") &&
-		static_cast<sQuestMsg*> (_message)->m_pName &&
 		parse (static_cast<sQuestMsg*> (_message)->m_pName).first
 			!= Objective::NONE),
 	objective (parse (MESSAGE_AS (sQuestMsg)->m_pName).first),
@@ -414,30 +415,51 @@ MESSAGE_WRAPPER_IMPL_ (ObjectiveMessage,
 
 ObjectiveMessage::ObjectiveMessage (const Objective& _objective, Field _field,
 		int _new_raw_value, int _old_raw_value)
-	: Message (new sQuestMsg ()), objective (_objective), field (_field),
+	: Message (new PooledMessage<sQuestMsg> ()),
+	  objective (_objective), field (_field),
 	  new_raw_value (_new_raw_value), old_raw_value (_old_raw_value)
 {
 	message->message = "QuestChange";
 	MESSAGE_AS (sQuestMsg)->m_newValue = new_raw_value;
 	MESSAGE_AS (sQuestMsg)->m_oldValue = old_raw_value;
 
-	// This baroque procedure intentionally leaks the quest variable name to
-	// deal with sQuestMsg's need for a const char* that we wouldn't know
-	// when to free later.
+	// sQuestMsg needs a const char* that we wouldn't know when to free, so
+	// the name is kept in the interning table, which is never pruned.
 	boost::format qvar_name ("goal_%||_%||");
 	qvar_name % EnumCoding::get<Field> ().encode (field) % objective.number;
-	char *leak = new char [qvar_name.size () + 1];
-	std::strcpy (leak, qvar_name.str ().data ());
-	MESSAGE_AS (sQuestMsg)->m_pName = leak;
+	auto entry = get_quest_vars ().emplace (qvar_name.str (),
+		ParseResult { objective.number, field }).first;
+	MESSAGE_AS (sQuestMsg)->m_pName = entry->first.data ();
 }
 
-ObjectiveMessage::ParseResult
-ObjectiveMessage::parse (const char* _quest_var)
+ObjectiveMessage::QuestVars&
+ObjectiveMessage::get_quest_vars ()
+{
+	// Constructed on first use so that the allocator is attached by then.
+	static QuestVars quest_vars;
+	return quest_vars;
+}
+
+const ObjectiveMessage::ParseResult&
+ObjectiveMessage::parse (const char* quest_var)
 {
 	static const ParseResult BAD_QV { Objective::NONE, Field (-1) };
+	if (!quest_var) return BAD_QV;
+
+	// Quest variable names are few and recur constantly, so each is parsed
+	// once and remembered, whether or not it is objective-related.
+	QuestVars& quest_vars = get_quest_vars ();
+	auto iter = quest_vars.find (quest_var);
+	if (iter == quest_vars.end ())
+		iter = quest_vars.emplace (quest_var, parse_uncached (quest_var))
+			.first;
+	return iter->second;
+}
 
-	if (!_quest_var) return BAD_QV;
-	String quest_var { _quest_var };
+ObjectiveMessage::ParseResult
+ObjectiveMessage::parse_uncached (const String& quest_var)
+{
+	static const ParseResult BAD_QV { Objective::NONE, Field (-1) };
 
 	if (quest_var.size () < 8 || quest_var.substr (0, 5) != "goal_")
 		return BAD_QV;
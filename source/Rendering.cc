@@ -145,13 +145,13 @@ AnimLight::is_anim_light () const
 void
 AnimLight::subscribe_light ()
 {
-	SService<ILightScrSrv> (LG)->Subscribe (number);
+	cached_service<ILightScrSrv> ()->Subscribe (number);
 }
 
 void
 AnimLight::unsubscribe_light ()
 {
-	SService<ILightScrSrv> (LG)->Unsubscribe (number);
+	cached_service<ILightScrSrv> ()->Unsubscribe (number);
 }
 
 
@@ -310,7 +310,7 @@ void
 FlashPoint::flash ()
 {
 	if (!is_flash_point ()) throw std::runtime_error ("not a flash point");
-	SService<IDarkPowerupsSrv> (LG)->TriggerWorldFlash (number);
+	cached_service<IDarkPowerupsSrv> ()->TriggerWorldFlash (number);
 }
 
 
@@ -372,7 +372,7 @@ TextureSwapper::is_texture_swapper () const
 bool
 TextureSwapper::swap_textures ()
 {
-	return SService<IAnimTextureSrv> (LG)->ChangeTexture (number,
+	return cached_service<IAnimTextureSrv> ()->ChangeTexture (number,
 		nullptr, String (old_texture).data (),
 		nullptr, String (new_texture).data ())
 			== S_OK;
@@ -385,7 +385,8 @@ TextureSwapper::swap_textures (const Vector& _center, float radius,
 	TextureSwapper swapper = Object::create_temp_fnord ();
 	swapper.set_location (_center);
 	swapper.swap_radius = radius;
-	return SService<IAnimTextureSrv> (LG)->ChangeTexture (swapper.number,
+	return cached_service<IAnimTextureSrv> ()->ChangeTexture
+		(swapper.number,
 		nullptr, old_texture.data (), nullptr, new_texture.data ())
 			== S_OK;
 }
@@ -24,6 +24,10 @@
  *****************************************************************************/
 
 #include "Private.hh"
+#include "OSL.hh"
+#include "ParameterCache.hh"
+#include <fstream>
+#include <tuple>
 
 namespace Thief {
 
@@ -54,6 +58,464 @@ OBJECT_TYPE_IMPL_ (ScriptHost, Lockable (),
 
 
 
+// Cooperative jobs
+
+// The timer that runs each round of a job's steps. Its data is the job name.
+// It is multiplexed onto the OSL's timer wheel, so a round runs on the first
+// frame at least one wheel tick (10 ms) after the previous round.
+#define JOB_TIMER "ThiefLibJob"
+
+// Persistent variables of the job's script hold its cursor and budget. Neither
+// prefix is a prefix of the other, so no two jobs' variables can collide.
+static const char* const JOB_CURSOR_PREFIX = "job_cursor_";
+static const char* const JOB_BUDGET_PREFIX = "job_budget_";
+
+
+
+// ScriptTask
+
+// The timer that wakes a sleeping task. Its data is "<generation>:<task>".
+#define TASK_TIMER "ThiefLibTask"
+
+// A persistent variable of the task's script holds its encoded state.
+static const char* const TASK_PREFIX = "task_";
+
+// Another holds the task's last generation, which outlives the task so that
+// a timer from an earlier run never matches a later one.
+static const char* const TASK_GENERATION_PREFIX = "taskgen_";
+
+// Each dispatch is numbered so that a task waiting for a message is not
+// resumed by the same message (or one nested within it) that began the wait.
+static unsigned long dispatch_count = 0ul;
+
+ScriptTask::Await::Await (Kind _kind, Time _delay, const CIString& _message)
+	: kind (_kind), delay (_delay), message (_message)
+{}
+
+ScriptTask::ScriptTask (const String& _name)
+	: name (_name),
+	  step (0u),
+	  next_step (1u),
+	  generation (0u),
+	  waiting (Await::NEXT),
+	  waiting_since (0ul)
+{}
+
+void
+ScriptTask::jump (size_t _step)
+{
+	next_step = _step;
+}
+
+bool
+ScriptTask::has_value (const String& key) const
+{
+	return values.find (key) != values.end ();
+}
+
+String
+ScriptTask::get_value (const String& key, const String& default_value) const
+{
+	auto value = values.find (key);
+	return (value != values.end ()) ? value->second : default_value;
+}
+
+void
+ScriptTask::set_value (const String& key, const String& value)
+{
+	values [key] = value;
+}
+
+ScriptTask::Await
+ScriptTask::next () const
+{
+	return Await (Await::NEXT);
+}
+
+ScriptTask::Await
+ScriptTask::sleep (Time duration) const
+{
+	return Await (Await::SLEEP, duration);
+}
+
+ScriptTask::Await
+ScriptTask::message (const CIString& _name) const
+{
+	return Await (Await::MESSAGE, 0ul, _name);
+}
+
+ScriptTask::Await
+ScriptTask::finish () const
+{
+	return Await (Await::FINISH);
+}
+
+String
+ScriptTask::encode () const
+{
+	std::ostringstream out;
+	out << step << ' ' << generation << ' ' << int (waiting) << ' ';
+	write_string (out, waiting_for.data ());
+	out << ' ' << values.size ();
+	for (auto& value : values)
+	{
+		out << ' ';
+		write_string (out, value.first);
+		out << ' ';
+		write_string (out, value.second);
+	}
+	return out.str ();
+}
+
+void
+ScriptTask::decode (const String& raw)
+{
+	std::istringstream in (raw);
+	int _waiting = Await::NEXT;
+	in >> step >> generation >> _waiting;
+	waiting = Await::Kind (_waiting);
+	waiting_for = read_string (in).data ();
+
+	size_t count = 0u;
+	in >> count;
+	values.clear ();
+	while (in && count-- > 0u)
+	{
+		String key = read_string (in);
+		values [key] = read_string (in);
+	}
+
+	if (!in)
+		throw std::runtime_error ("malformed task state");
+}
+
+
+
+// DispatchProfile
+
+#ifdef THIEF_PROFILE
+
+// Script modules run on the engine's single thread, so the records need no
+// locking. They are kept per module and live until the module is unloaded.
+
+struct DispatchProfile
+{
+	enum { BUCKETS = 16 }; // by power of two of microseconds
+
+	struct Record
+	{
+		Record () : calls (0u), total (0), worst (0) { histogram.fill (0u); }
+
+		unsigned long calls;
+		LONGLONG total, worst; // in performance counter ticks
+		std::array<unsigned long, BUCKETS> histogram;
+	};
+
+	// script name, message name or timer name, handler number (0 = all)
+	typedef std::tuple<String, CIString, size_t> Key;
+	typedef std::map<Key, Record> Records;
+	Records records;
+	LONGLONG frequency;
+
+	static DispatchProfile& get ();
+	static LONGLONG now ();
+
+	void record (const String& script, const CIString& message,
+		size_t handler, LONGLONG start);
+	void dump (std::ostream& out) const;
+
+private:
+	DispatchProfile ();
+};
+
+DispatchProfile::DispatchProfile ()
+	: frequency (0)
+{
+	LARGE_INTEGER _frequency;
+	if (QueryPerformanceFrequency (&_frequency))
+		frequency = _frequency.QuadPart;
+}
+
+DispatchProfile&
+DispatchProfile::get ()
+{
+	// Constructed on first use so that the allocator is attached by then.
+	static DispatchProfile profile;
+	return profile;
+}
+
+LONGLONG
+DispatchProfile::now ()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter (&counter);
+	return counter.QuadPart;
+}
+
+void
+DispatchProfile::record (const String& script, const CIString& message,
+	size_t handler, LONGLONG start)
+{
+	LONGLONG elapsed = now () - start;
+	Record& stats = records [Key (script, message, handler)];
+	++stats.calls;
+	stats.total += elapsed;
+	stats.worst = std::max (stats.worst, elapsed);
+
+	LONGLONG micros = frequency ? elapsed * 1000000 / frequency : 0;
+	size_t bucket = 0u;
+	while (micros > 0 && bucket < BUCKETS - 1u)
+		{ micros >>= 1; ++bucket; }
+	++stats.histogram [bucket];
+}
+
+void
+DispatchProfile::dump (std::ostream& out) const
+{
+	static const boost::format RECORD
+		("%|-24| %|-24| %|3| %|8| calls %|10.1f| us mean %|10.1f| us worst |");
+	double scale = frequency ? 1000000.0 / double (frequency) : 0.0;
+
+	out << "Script dispatch profile (" << records.size () << " records; "
+		"handler 0 is the whole dispatch; histogram buckets are powers "
+		"of two of microseconds):" << std::endl;
+
+	for (auto& entry : records)
+	{
+		const Record& stats = entry.second;
+		out << boost::format (RECORD)
+			% std::get<0> (entry.first) % std::get<1> (entry.first)
+			% std::get<2> (entry.first) % stats.calls
+			% (double (stats.total) * scale / double (stats.calls))
+			% (double (stats.worst) * scale);
+		for (auto count : stats.histogram)
+			out << ' ' << count;
+		out << std::endl;
+	}
+}
+
+#endif // THIEF_PROFILE
+
+
+
+// Script::LogBuffer
+
+// Log messages are recorded unformatted in a ring buffer and formatted and
+// output once the outermost message dispatch finishes. Script modules run on
+// the engine's single thread, so the buffer needs no locking. Formats are
+// copied into the records, so the caller's storage need not outlive the call.
+
+class Script::LogBuffer
+{
+public:
+	static LogBuffer& get ();
+
+	void push (const Script& script, Log level, const String& format,
+		const LogArg* args, size_t count);
+	void flush ();
+
+	// Flushes the buffer when the outermost dispatch finishes.
+	class Frame
+	{
+	public:
+		Frame () { ++depth; }
+		~Frame () { if (--depth == 0u) get ().flush (); }
+	};
+
+private:
+	LogBuffer ();
+	~LogBuffer ();
+
+	enum { CAPACITY = 256, MAX_ARGS = 8 };
+
+	struct Record
+	{
+		const Script* script;
+		Log level;
+		Time sim_time;
+		String format;
+		size_t count;
+		std::array<LogArg, MAX_ARGS> args;
+	};
+
+	Record* reserve (const Script& script, Log level, const LogArg* args,
+		size_t count);
+
+	static void emit (const Script& script, Log level, Time sim_time,
+		const char* format, const LogArg* args, size_t count);
+	static void on_mono_log ();
+
+	std::array<Record, CAPACITY> records;
+	size_t head, used;
+	bool flushing;
+
+	static size_t depth;
+};
+
+size_t
+Script::LogBuffer::depth = 0u;
+
+Script::LogBuffer::LogBuffer ()
+	: head (0u), used (0u), flushing (false)
+{
+	// Keep direct monolog lines from this module in order with records.
+	Monolog::set_log_hook (&on_mono_log);
+}
+
+Script::LogBuffer::~LogBuffer ()
+{
+	Monolog::set_log_hook (nullptr);
+}
+
+Script::LogBuffer&
+Script::LogBuffer::get ()
+{
+	// Constructed on first use so that the allocator is attached by then.
+	static LogBuffer buffer;
+	return buffer;
+}
+
+void
+Script::LogBuffer::push (const Script& script, Log level,
+	const String& format, const LogArg* args, size_t count)
+{
+	Record* _record = reserve (script, level, args, count);
+	if (!_record)
+	{
+		emit (script, level, script.sim_time, format.data (), args,
+			count);
+		return;
+	}
+
+	_record->format = format;
+	if (depth == 0u)
+		flush ();
+}
+
+Script::LogBuffer::Record*
+Script::LogBuffer::reserve (const Script& script, Log level,
+	const LogArg* args, size_t count)
+{
+	if (count > MAX_ARGS) // too many to record; output them directly
+	{
+		flush ();
+		return nullptr;
+	}
+
+	if (used == CAPACITY)
+		flush ();
+
+	// Records logged outside any dispatch (such as from HUD drawing
+	// handlers or during destruction) have no frame end to wait for, so
+	// the caller flushes them once the format is in place.
+	Record& record = records [(head + used) % CAPACITY];
+	record.script = &script;
+	record.level = level;
+	record.sim_time = script.sim_time;
+	record.count = count;
+	std::copy (args, args + count, record.args.begin ());
+	++used;
+	return &record;
+}
+
+void
+Script::LogBuffer::flush ()
+{
+	if (flushing) return; // Don't recurse from mono().
+	flushing = true;
+
+	while (used > 0u)
+	{
+		Record& record = records [head];
+		try
+		{
+			emit (*record.script, record.level, record.sim_time,
+				record.format.data (),
+				record.args.data (), record.count);
+		}
+		catch (...) {}
+		record.format.clear ();
+		for (size_t arg = 0u; arg < record.count; ++arg)
+			record.args [arg].text.clear ();
+		head = (head + 1u) % CAPACITY;
+		--used;
+	}
+
+	head = 0u;
+	flushing = false;
+}
+
+void
+Script::LogBuffer::on_mono_log ()
+{
+	get ().flush ();
+}
+
+void
+Script::LogBuffer::emit (const Script& script, Log level, Time sim_time,
+	const char* _format, const LogArg* args, size_t count)
+{
+	boost::format format;
+	try
+	{
+		format.parse (_format);
+		for (const LogArg* arg = args; arg != args + count; ++arg)
+			switch (arg->type)
+			{
+			case LogArg::BOOL: format % bool (arg->signed_value); break;
+			case LogArg::CHAR: format % char (arg->signed_value); break;
+			case LogArg::SIGNED: format % arg->signed_value; break;
+			case LogArg::UNSIGNED: format % arg->unsigned_value; break;
+			case LogArg::REAL: format % arg->real_value; break;
+			case LogArg::TEXT: format % arg->text; break;
+			case LogArg::OBJECT:
+				format % Object (Object::Number (arg->signed_value));
+				break;
+			case LogArg::NONE: default: format % ""; break;
+			}
+		script.mono_prefix (level, sim_time) << format.str () << std::endl;
+	}
+	catch (boost::io::format_error&)
+	{
+		script.mono_prefix (Log::WARNING, sim_time)
+			<< "Could not format log message \"" << _format << "\"."
+			<< std::endl;
+	}
+}
+
+
+
+// TimerFlush
+
+// The OSL's timer wheel writes changed timers to the saved-game store in a
+// batch. A game can only be saved between messages, so the batch is written
+// once the outermost dispatch finishes.
+
+class TimerFlush
+{
+public:
+	TimerFlush () { ++depth; }
+	~TimerFlush ();
+
+private:
+	static unsigned depth;
+};
+
+unsigned
+TimerFlush::depth = 0u;
+
+TimerFlush::~TimerFlush ()
+{
+	if (--depth == 0u)
+		try
+		{
+			cached_service<IOSLService> ()->flush_timers ();
+		}
+		catch (...) {}
+}
+
+
+
 // Script::Impl
 
 class Script::Impl : public cInterfaceImp<IScript>
@@ -91,12 +553,23 @@ STDMETHODIMP
 Script::Impl::ReceiveMessage (sScrMsg* message, sMultiParm* reply,
 	eScrTraceAction trace)
 {
+	LogBuffer::Frame frame;
+	TimerFlush timers;
+	ExistenceCache::Dispatch existence;
 	try
 	{
 		if (!message)
 			throw MessageWrapError (message, "Message",
 				"message is null");
+#ifdef THIEF_PROFILE
+		LONGLONG start = DispatchProfile::now ();
+		bool result = script.dispatch (*message, reply, trace);
+		DispatchProfile::get ().record (script.script_name,
+			message->message, 0u, start);
+		return result ? S_OK : S_FALSE;
+#else // !THIEF_PROFILE
 		return script.dispatch (*message, reply, trace) ? S_OK : S_FALSE;
+#endif // THIEF_PROFILE
 	}
 	catch (std::exception& e)
 	{
@@ -138,7 +611,14 @@ Script::Script (const String& _name, const Object& _host, Log _min_level)
 	  initialized (false),
 	  sim (Engine::is_sim ()),
 	  post_sim (false)
-{}
+{
+	// Any ThiefLib script's host can drive the OSL's timer wheel.
+	try
+	{
+		cached_service<IOSLService> ()->retain_timer_host (host ());
+	}
+	catch (...) {}
+}
 
 Script::~Script ()
 {
@@ -154,16 +634,33 @@ Script::~Script ()
 			catch (...) {}
 		}
 		catch (...) {}
+
+	// If this was the last ThiefLib script on a host driving the OSL's
+	// timer wheel, the tick must move elsewhere.
+	try
+	{
+		cached_service<IOSLService> ()->release_timer_host (host ());
+	}
+	catch (...) {}
+
+	// Pending log records may refer to this script.
+	LogBuffer::get ().flush ();
 }
 
 void
 Script::initialize ()
 {
 	// Adjust minimum logging level based on "debug" parameter or "debug"
-	// quest variable, if any.
-	Parameter<Log> min_level_param (host (), "debug", {});
-	if (min_level_param.exists ())
-		min_level = min_level_param;
+	// quest variable, if any. The parameter cache indexes the parameter for
+	// all scripts, so only a script that has it needs to read it in full.
+	ParameterCache* cache = cached_service<IOSLService> ()->get_param_cache
+		();
+	if (cache && cache->get_debug_param (host ()))
+	{
+		Parameter<Log> min_level_param (host (), "debug", {});
+		if (min_level_param.exists ())
+			min_level = min_level_param;
+	}
 	else
 		switch (QuestVar ("debug"))
 		{
@@ -191,6 +688,31 @@ void
 Script::deinitialize ()
 {}
 
+void
+Script::dump_profile (const String& path)
+{
+#ifdef THIEF_PROFILE
+	DispatchProfile::get ().dump (Thief::mono);
+	alloc.dump_pools (Thief::mono);
+	if (!path.empty ())
+	{
+		std::ofstream file (path.data ());
+		if (file)
+		{
+			DispatchProfile::get ().dump (file);
+			alloc.dump_pools (file);
+		}
+		else
+			Thief::mono << "WARNING: Could not write script dispatch "
+				"profile to \"" << path << "\"." << std::endl;
+	}
+#else // !THIEF_PROFILE
+	(void) path;
+	Thief::mono << "Script dispatch profiling is not enabled in this "
+		"build of ThiefLib." << std::endl;
+#endif // THIEF_PROFILE
+}
+
 IScript*
 Script::get_interface ()
 {
@@ -204,6 +726,15 @@ Script::mono (Log level) const
 	if (int (level) < int (min_level))
 		return null_mono;
 
+	// Keep any deferred log messages in order with this output.
+	LogBuffer::get ().flush ();
+
+	return mono_prefix (level, sim_time);
+}
+
+Monolog&
+Script::mono_prefix (Log level, Time time) const
+{
 	const char* prefix = "";
 	switch (level)
 	{
@@ -213,13 +744,24 @@ Script::mono (Log level) const
 	default: break;
 	}
 
-	static const boost::format format ("%|-7| [%|4|.%|03|] %|| [%||]: ");
-	Thief::mono << boost::format (format) % prefix % (sim_time / 1000ul)
-		% (sim_time % 1000ul) % script_name % host_obj;
+	// Equivalent to "%|-7| [%|4|.%|03|] %|| [%||]: " but without a format.
+	unsigned long _time = Time::Value (time);
+	Thief::mono << std::left << std::setw (7) << prefix << std::right
+		<< " [" << std::setw (4) << (_time / 1000ul) << '.'
+		<< std::setfill ('0') << std::setw (3) << (_time % 1000ul)
+		<< std::setfill (' ') << "] " << script_name
+		<< " [" << host_obj << "]: ";
 
 	return Thief::mono;
 }
 
+void
+Script::defer_log (Log level, const String& format, const LogArg* args,
+	size_t count) const
+{
+	LogBuffer::get ().push (*this, level, format, args, count);
+}
+
 void
 Script::fix_player_links ()
 {
@@ -242,10 +784,37 @@ bool
 Script::dispatch (sScrMsg& message, sMultiParm* reply, unsigned trace)
 {
 	sim_time = message.time;
+	unsigned long dispatch = ++dispatch_count;
+
+	// The OSL's timer wheel is driven by a one-shot timer on a script host,
+	// set for the next tick on which a timer is due.
+	if (_stricmp (message.message, "Timer") == 0 &&
+	    _stricmp ((const char*) static_cast<sScrTimerMsg*> (&message)->name,
+			TIMER_WHEEL_TICK) == 0)
+	{
+		TimerMessage timer (&message, reply);
+		cached_service<IOSLService> ()->advance_timers (sim_time,
+			timer.get_data<int> (Message::DATA1));
+		return true;
+	}
 
 	if (!sim && _stricmp (message.message, "PhysMadeNonPhysical") == 0)
 		return true; // Silently ignore these to avoid extra work.
 
+#ifdef THIEF_PROFILE
+	// A message reaches each ThiefLib script on its object, but the profile
+	// is for the whole module. It is passed on to any handlers as usual.
+	static const sScrMsg* dumped_message = nullptr;
+	static Time::Value dumped_time = 0ul;
+	if (_stricmp (message.message, "DumpProfile") == 0 &&
+	    (&message != dumped_message || message.time != dumped_time))
+	{
+		dumped_message = &message;
+		dumped_time = message.time;
+		dump_profile ();
+	}
+#endif // THIEF_PROFILE
+
 	mono ((trace != kNoAction) ? Log::NORMAL : Log::VERBOSE)
 		<< "Got message \"" << message.message << "\"."
 		<< (trace == kBreak ? " Breaking." : "") << std::endl;
@@ -255,10 +824,39 @@ Script::dispatch (sScrMsg& message, sMultiParm* reply, unsigned trace)
 
 	if (!initialized && _stricmp (message.message, "EndScript") != 0)
 	{
+		load_tasks ();
 		initialize ();
 		initialized = true;
 	}
 
+	if (_stricmp (message.message, "Timer") == 0 &&
+	    _stricmp ((const char*) static_cast<sScrTimerMsg*> (&message)->name,
+			JOB_TIMER) == 0)
+	{
+		TimerMessage timer (&message, reply);
+		run_job (timer.get_data<String> (Message::DATA1));
+		return true;
+	}
+
+	if (_stricmp (message.message, "Timer") == 0 &&
+	    _stricmp ((const char*) static_cast<sScrTimerMsg*> (&message)->name,
+			TASK_TIMER) == 0)
+	{
+		TimerMessage timer (&message, reply);
+		String data = timer.get_data<String> (Message::DATA1);
+		size_t colon = data.find (':');
+		if (colon == String::npos) return true;
+
+		// A restarted or stopped task may leave a stale timer behind.
+		auto task = tasks.find (data.substr (colon + 1u).data ());
+		if (task != tasks.end () &&
+		    task->second.waiting == ScriptTask::Await::SLEEP &&
+		    std::to_string (task->second.generation) ==
+				data.substr (0u, colon))
+			run_task (task->first);
+		return true;
+	}
+
 	if (_stricmp (message.message, "Sim") == 0)
 	{
 		sim = static_cast<sSimMsg*> (&message)->fStarting;
@@ -280,20 +878,18 @@ Script::dispatch (sScrMsg& message, sMultiParm* reply, unsigned trace)
 	bool result = dispatch_cycle
 		(message_handlers, message.message, message, reply);
 
-	if (_stricmp (message.message, "QuestChange") == 0)
-		try
-		{
-			ObjectiveMessage check_type (&message, reply);
-			result &= dispatch_cycle (message_handlers,
-				"ObjectiveChange", message, reply);
-		}
-		catch (...) {} // The quest variable is not objective-related.
+	if (ObjectiveMessage::matches (&message))
+		result &= dispatch_cycle (message_handlers,
+			"ObjectiveChange", message, reply);
 
 	if (_stricmp (message.message, "Timer") == 0)
 		result &= dispatch_cycle (timer_handlers, (const char*)
 			static_cast<sScrTimerMsg*> (&message)->name,
 			message, reply);
 
+	if (!tasks.empty ())
+		resume_tasks (message.message, dispatch);
+
 	if (initialized && _stricmp (message.message, "EndScript") == 0)
 	{
 		deinitialize ();
@@ -309,9 +905,17 @@ Script::dispatch_cycle (Handlers& candidates, const CIString& key,
 {
 	bool cycle_result = true;
 
+#ifdef THIEF_PROFILE
+	size_t handler = 0u;
+#endif
+
 	auto matches = candidates.equal_range (key);
 	for (auto match = matches.first; match != matches.second; ++match)
 	{
+#ifdef THIEF_PROFILE
+		LONGLONG start = DispatchProfile::now ();
+#endif
+
 		Message::Result result = Message::ERROR;
 		try
 		{
@@ -322,6 +926,11 @@ Script::dispatch_cycle (Handlers& candidates, const CIString& key,
 		catch (...)
 			{ log (Log::ERROR, "An unknown error occurred."); }
 
+#ifdef THIEF_PROFILE
+		DispatchProfile::get ().record (script_name, key, ++handler,
+			start);
+#endif
+
 		switch (result)
 		{
 		case Message::CONTINUE:
@@ -338,12 +947,234 @@ Script::dispatch_cycle (Handlers& candidates, const CIString& key,
 	return cycle_result;
 }
 
+void
+Script::start_job (const String& job, unsigned long budget)
+{
+	Persistent<int> cursor (*this, JOB_CURSOR_PREFIX + job);
+	Persistent<int> _budget (*this, JOB_BUDGET_PREFIX + job);
+	bool running = cursor.exists ();
+	cursor = 0;
+	_budget = int (budget);
+
+	// A running job already has a timer pending.
+	if (!running)
+		start_timer (JOB_TIMER, 1ul, false, job);
+}
+
+bool
+Script::stop_job (const String& job)
+{
+	Persistent<int> cursor (*this, JOB_CURSOR_PREFIX + job);
+	Persistent<int> (*this, JOB_BUDGET_PREFIX + job).remove ();
+	if (!cursor.remove ()) return false;
+
+	// The pending timer will find the job stopped and do nothing.
+	cached_service<IOSLService> ()->end_job (host (), script_name.data (),
+		job.data (), 0ul, true);
+	return true;
+}
+
+void
+Script::run_job (const String& job)
+{
+	Persistent<int> cursor (*this, JOB_CURSOR_PREFIX + job);
+	Persistent<int> budget (*this, JOB_BUDGET_PREFIX + job, 1000);
+	if (!cursor.exists ()) return; // The job was stopped.
+
+	IOSLService* osl = cached_service<IOSLService> ();
+	bool more = true;
+	unsigned long spent = 0ul;
+
+	auto step = job_steps.find (job);
+	if (step == job_steps.end ())
+	{
+		log (Log::WARNING, "No handler is listening for job \"%||\"; "
+			"stopping it.", job);
+		more = false;
+	}
+	else if (unsigned long allowed = osl->begin_job (host (),
+		script_name.data (), job.data (), budget, sim_time))
+	{
+		LARGE_INTEGER frequency, start, now;
+		QueryPerformanceFrequency (&frequency);
+		QueryPerformanceCounter (&start);
+
+		int _cursor = cursor;
+		try
+		{
+			do
+			{
+				more = step->second (*this, _cursor);
+				QueryPerformanceCounter (&now);
+				spent = (now.QuadPart - start.QuadPart) * 1000000
+					/ std::max (frequency.QuadPart, 1LL);
+			}
+			while (more && spent < allowed);
+		}
+		catch (std::exception& e)
+		{
+			log (Log::ERROR, "Job \"%||\" failed and was stopped: %||",
+				job, e.what ());
+			more = false;
+		}
+		cursor = _cursor;
+	}
+
+	osl->end_job (host (), script_name.data (), job.data (), spent, !more);
+
+	if (more)
+		start_timer (JOB_TIMER, 1ul, false, job);
+	else
+	{
+		cursor.remove ();
+		budget.remove ();
+	}
+}
+
+void
+Script::start_task (const String& name)
+{
+	CIString key (name.data ());
+	ScriptTask task (name);
+	task.generation = next_task_generation (name);
+
+	tasks.erase (key);
+	tasks.insert (std::make_pair (key, task));
+	run_task (key);
+}
+
+bool
+Script::stop_task (const String& name)
+{
+	Persistent<String> (*this, TASK_PREFIX + name).remove ();
+	return tasks.erase (CIString (name.data ())) != 0u;
+}
+
+void
+Script::load_tasks ()
+{
+	tasks.clear ();
+	for (auto& steps : task_steps)
+	{
+		String name (steps.first.data ());
+		Persistent<String> state (*this, TASK_PREFIX + name);
+		if (!state.exists ()) continue;
+
+		ScriptTask task (name);
+		try
+		{
+			task.decode (state);
+			tasks.insert (std::make_pair (steps.first, task));
+		}
+		catch (std::exception& e)
+		{
+			log (Log::WARNING, "Could not restore task \"%||\": %||.",
+				name, e.what ());
+			state.remove ();
+		}
+	}
+}
+
+unsigned
+Script::next_task_generation (const String& name)
+{
+	Persistent<int> last (*this, TASK_GENERATION_PREFIX + name, 0);
+	unsigned generation = unsigned (int (last)) + 1u;
+	last = int (generation);
+	return generation;
+}
+
+void
+Script::run_task (const CIString& key)
+{
+	String name (key.data ());
+	Persistent<String> state (*this, TASK_PREFIX + name);
+	auto steps = task_steps.find (key);
+
+	for (auto task = tasks.find (key); task != tasks.end ();
+	     task = tasks.find (key))
+	{
+		if (steps == task_steps.end () ||
+		    task->second.step >= steps->second.size ())
+			break; // There are no more steps.
+
+		// The step may restart or stop its own task.
+		unsigned generation = task->second.generation;
+		task->second.next_step = task->second.step + 1u;
+		ScriptTask::Await await (ScriptTask::Await::FINISH);
+		try
+		{
+			await = steps->second [task->second.step]
+				(*this, task->second);
+		}
+		catch (std::exception& e)
+		{
+			log (Log::ERROR, "Task \"%||\" failed at step %|| and was "
+				"stopped: %||", name, task->second.step, e.what ());
+		}
+
+		task = tasks.find (key);
+		if (task == tasks.end () || task->second.generation != generation)
+			return;
+
+		ScriptTask& _task = task->second;
+		_task.step = _task.next_step;
+		_task.waiting = await.kind;
+		_task.waiting_for = await.message;
+
+		switch (await.kind)
+		{
+		case ScriptTask::Await::NEXT:
+			continue;
+		case ScriptTask::Await::SLEEP:
+			_task.generation = next_task_generation (name);
+			start_timer (TASK_TIMER, await.delay, false,
+				std::to_string (_task.generation) + ':' + name);
+			state = _task.encode ();
+			return;
+		case ScriptTask::Await::MESSAGE:
+			_task.waiting_since = dispatch_count;
+			state = _task.encode ();
+			return;
+		case ScriptTask::Await::FINISH:
+		default:
+			break;
+		}
+		break;
+	}
+
+	state.remove ();
+	tasks.erase (key);
+}
+
+void
+Script::resume_tasks (const CIString& message, unsigned long dispatch)
+{
+	std::vector<CIString> waiting;
+	for (auto& task : tasks)
+		if (task.second.waiting == ScriptTask::Await::MESSAGE &&
+		    task.second.waiting_for == message &&
+		    task.second.waiting_since < dispatch)
+			waiting.push_back (task.first);
+
+	for (auto& key : waiting)
+	{
+		auto task = tasks.find (key);
+		if (task != tasks.end () &&
+		    task->second.waiting == ScriptTask::Await::MESSAGE)
+			run_task (key);
+	}
+}
+
 Timer
 Script::_start_timer (const char* timer, Time delay, bool repeating,
 	const LGMultiBase& data)
 {
-	return Timer (LG->SetTimedMessage2 (host ().number, timer, delay,
-		repeating ? kSTM_Periodic : kSTM_OneShot, data));
+	TimerMessage message (timer);
+	if (!data.empty ())
+		message.set_data (Message::DATA1, (const sMultiParm&) data);
+	return message._schedule (Object::NONE, host (), delay, repeating,
+		host (), sim_time);
 }
 
 
@@ -433,7 +1264,7 @@ TrapTrigger::initialize ()
 }
 
 void
-TrapTrigger::trigger (bool on, bool conditional, bool filtered)
+TrapTrigger::trigger (bool on, bool conditional, bool filtered, bool queued)
 {
 	if ((conditional && host ().is_locked ()) ||
 	    (filtered && on && !host ().trap_on) ||
@@ -444,7 +1275,7 @@ TrapTrigger::trigger (bool on, bool conditional, bool filtered)
 		on = !on;
 
 	GenericMessage (on ? "TurnOn" : "TurnOff").broadcast
-		(host (), "ControlDevice");
+		(host (), "ControlDevice", 0ul, queued);
 
 	if (conditional && host ().trap_once)
 		host ().set_locked (true);
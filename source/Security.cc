@@ -40,7 +40,7 @@ OBJECT_TYPE_IMPL_ (Lockable,
 bool
 Lockable::is_locked () const
 {
-	return SService<ILockSrv> (LG)->IsLocked (number);
+	return cached_service<ILockSrv> ()->IsLocked (number);
 }
 
 void
@@ -105,7 +105,7 @@ Key::is_key () const
 bool
 Key::try_key_operation (Operation operation, const Lockable& lock)
 {
-	return SService<IKeySrv> (LG)->TryToUseKey
+	return cached_service<IKeySrv> ()->TryToUseKey
 		(number, lock.number, eKeyUse (operation));
 }
 
@@ -138,25 +138,25 @@ Door::is_door () const
 Door::State
 Door::get_door_state () const
 {
-	return State (SService<IDoorSrv> (LG)->GetDoorState (number));
+	return State (cached_service<IDoorSrv> ()->GetDoorState (number));
 }
 
 bool
 Door::open_door ()
 {
-	return SService<IDoorSrv> (LG)->OpenDoor (number);
+	return cached_service<IDoorSrv> ()->OpenDoor (number);
 }
 
 bool
 Door::close_door ()
 {
-	return SService<IDoorSrv> (LG)->CloseDoor (number);
+	return cached_service<IDoorSrv> ()->CloseDoor (number);
 }
 
 bool
 Door::toggle_door ()
 {
-	return SService<IDoorSrv> (LG)->ToggleDoor (number);
+	return cached_service<IDoorSrv> ()->ToggleDoor (number);
 }
 
 #ifndef IS_OSL
@@ -164,13 +164,13 @@ Door::toggle_door ()
 bool
 Door::get_blocks_sound () const
 {
-	return SService<IDoorSrv> (LG)->GetSoundBlocking (number);
+	return cached_service<IDoorSrv> ()->GetSoundBlocking (number);
 }
 
 void
 Door::set_blocks_sound (bool blocks_sound)
 {
-	SService<IDoorSrv> (LG)->SetBlocking (number, blocks_sound);
+	cached_service<IDoorSrv> ()->SetBlocking (number, blocks_sound);
 }
 
 #endif // !IS_OSL
@@ -230,7 +230,7 @@ MESSAGE_WRAPPER_IMPL_ (DoorMessage,
 }
 
 DoorMessage::DoorMessage (Door::State _new_state, Door::State _old_state)
-	: Message (new sDoorMsg ()), new_state (_new_state),
+	: Message (new PooledMessage<sDoorMsg> ()), new_state (_new_state),
 	  old_state (_old_state)
 {
 	switch (new_state)
@@ -440,7 +440,8 @@ MESSAGE_WRAPPER_IMPL (PickMessage, "PickStateChange"),
 
 PickMessage::PickMessage (AdvPickable::Stage _new_stage,
 		AdvPickable::Stage _old_stage)
-	: Message (new sPickStateScrMsg ()), new_stage (_new_stage),
+	: Message (new PooledMessage<sPickStateScrMsg> ()),
+	  new_stage (_new_stage),
 	  old_stage (_old_stage)
 {
 	message->message = "PickStateChange";
@@ -468,13 +469,13 @@ Lockpick::is_lockpick () const
 bool
 Lockpick::prepare_pick (const Object& host)
 {
-	return SService<IPickLockSrv> (LG)->Ready (host.number, number);
+	return cached_service<IPickLockSrv> ()->Ready (host.number, number);
 }
 
 bool
 Lockpick::release_pick (const Object& host)
 {
-	return SService<IPickLockSrv> (LG)->UnReady (host.number, number);
+	return cached_service<IPickLockSrv> ()->UnReady (host.number, number);
 }
 
 bool
@@ -487,21 +488,22 @@ Lockpick::can_pick (const Lockable& lock) const
 	// 1: can pick at current stage
 	// 4: locked, cannot pick
 	// 5: unlocked
-	return SService<IPickLockSrv> (LG)->CheckPick (number, lock.number, 0)
+	return cached_service<IPickLockSrv> ()->CheckPick (number, lock.number,
+		0)
 		== 1;
 }
 
 bool
 Lockpick::start_picking (const Lockable& lock, const Object& host)
 {
-	return SService<IPickLockSrv> (LG)->StartPicking
+	return cached_service<IPickLockSrv> ()->StartPicking
 		(host.number, number, lock.number);
 }
 
 bool
 Lockpick::finish_picking ()
 {
-	return SService<IPickLockSrv> (LG)->FinishPicking (number);
+	return cached_service<IPickLockSrv> ()->FinishPicking (number);
 }
 
 
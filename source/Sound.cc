@@ -122,7 +122,7 @@ SoundSchema::play (const Object& source, const Object& _host)
 {
 	Object host = (_host == Object::SELF) ? source : _host;
 	LGBool success;
-	SService<ISoundScrSrv> (LG)->PlaySchemaAtObject
+	cached_service<ISoundScrSrv> ()->PlaySchemaAtObject
 		(success, host.number, number, source.number _SOUND_NET);
 	return success;
 }
@@ -131,7 +131,7 @@ bool
 SoundSchema::play (const Vector& source, const Object& host)
 {
 	LGBool success;
-	SService<ISoundScrSrv> (LG)->PlaySchemaAtLocation
+	cached_service<ISoundScrSrv> ()->PlaySchemaAtLocation
 		(success, host.number, number, LGVector (source) _SOUND_NET);
 	return success;
 }
@@ -140,7 +140,7 @@ bool
 SoundSchema::play_ambient (const Object& host)
 {
 	LGBool success;
-	SService<ISoundScrSrv> (LG)->PlaySchemaAmbient
+	cached_service<ISoundScrSrv> ()->PlaySchemaAmbient
 		(success, host.number, number _SOUND_NET);
 	return success;
 }
@@ -148,14 +148,14 @@ SoundSchema::play_ambient (const Object& host)
 bool
 SoundSchema::played_as_voiceover () const
 {
-	return SInterface<IVoiceOverSys> (LG)->AlreadyPlayed (number);
+	return cached_interface<IVoiceOverSys> ()->AlreadyPlayed (number);
 }
 
 bool
 SoundSchema::play_voiceover (const Object& host)
 {
 	LGBool success;
-	SService<ISoundScrSrv> (LG)->PlayVoiceOver
+	cached_service<ISoundScrSrv> ()->PlayVoiceOver
 		(success, host.number, number);
 	return success;
 }
@@ -165,7 +165,7 @@ SoundSchema::halt (const Object& source, const Object& _host)
 {
 	Object host = (_host == Object::SELF) ? source : _host;
 	LGBool success;
-	SService<ISoundScrSrv> (LG)->HaltSchema
+	cached_service<ISoundScrSrv> ()->HaltSchema
 		(success, source.number, get_name ().data (), host.number);
 	return success;
 }
@@ -175,7 +175,7 @@ SoundSchema::halt_all (const Object& source, const Object& _host)
 {
 	Object host = (_host == Object::SELF) ? source : _host;
 	LGBool success;
-	SService<ISoundScrSrv> (LG)->HaltSchema
+	cached_service<ISoundScrSrv> ()->HaltSchema
 		(success, source.number, "", host.number);
 	return success;
 }
@@ -188,7 +188,7 @@ SoundSchema::play_by_tags (const String& tags, Tagged location,
 {
 	Object host = (_host == Object::SELF) ? source1 : _host;
 	LGBool success;
-	SService<ISoundScrSrv> (LG)->PlayEnvSchema
+	cached_service<ISoundScrSrv> ()->PlayEnvSchema
 		(success, host.number, tags.data (), source1.number,
 			source2.number, eEnvSoundLoc (location) _SOUND_NET);
 	return success;
@@ -261,7 +261,7 @@ MESSAGE_WRAPPER_IMPL (SchemaDoneMessage, "SchemaDone"),
 
 SchemaDoneMessage::SchemaDoneMessage (const Vector& _location,
 		const Object& _sound_source, const String& _schema_name)
-	: Message (new sSchemaDoneMsg ()), location (_location),
+	: Message (new PooledMessage<sSchemaDoneMsg> ()), location (_location),
 	  sound_source (_sound_source), schema_name (_schema_name)
 {
 	message->message = "SchemaDone";
@@ -0,0 +1,821 @@
+/******************************************************************************
+ *  TimerWheel.cc
+ *
+ *  This file is part of ThiefLib, a library for Thief 1/2 script modules.
+ *  Copyright (C) 2013 Kevin Daughtridge <kevin@kdau.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#include "Private.hh"
+#include "TimerWheel.hh"
+
+namespace Thief {
+
+
+
+// Wheel geometry and timer IDs
+
+// The length of one tick of the wheel. The engine timer that drives the wheel
+// is only set for ticks on which a timer is due (or an outer level cascades),
+// so idle ticks cost nothing.
+static const Time::Value RESOLUTION = 10ul;
+
+// Delays beyond the range of the outermost level (about 7.7 days) are clamped.
+static const unsigned long MAX_TICKS = 1ul << 26;
+
+// IDs of wheel timers are odd, while engine timer IDs are aligned heap
+// addresses, which can use the high bit in a large-address-aware process. The
+// generation guards against cancelling a later timer occupying the same slot.
+static const uintptr_t ID_TAG = 0x1u;
+static const unsigned SLOT_SHIFT = 1u;
+static const unsigned GENERATION_SHIFT = 17u;
+static const unsigned GENERATION_MASK = 0x7FFFu;
+static const int MAX_SLOTS = 0x10000;
+
+
+
+// Persistence in the engine's script data store
+
+static const char* const DATUM_CLASS = "ThiefLib";
+static const char* const SLOTS_DATUM = "timer_wheel_slots";
+static const char* const TICK_DATUM = "timer_wheel_tick";
+
+static String
+slot_datum (int slot)
+{
+	return "timer_wheel_" + std::to_string (slot);
+}
+
+static bool
+get_datum (const String& name, LGMultiBase& value)
+{
+	sScrDatumTag tag { Object::NONE.number, DATUM_CLASS, name.data () };
+	return LG->IsScriptDataSet (&tag) &&
+		LG->GetScriptData (&tag, &(sMultiParm&)value) == S_OK;
+}
+
+static void
+set_datum (const String& name, const LGMultiBase& value)
+{
+	sScrDatumTag tag { Object::NONE.number, DATUM_CLASS, name.data () };
+	LG->SetScriptData (&tag, &(const sMultiParm&)value);
+}
+
+static void
+clear_datum (const String& name)
+{
+	LGMulti<Empty> junk;
+	sScrDatumTag tag { Object::NONE.number, DATUM_CLASS, name.data () };
+	LG->ClearScriptData (&tag, &(sMultiParm&)junk);
+}
+
+static void
+write_slot (std::ostream& out, const LGMultiBase& slot)
+{
+	const sMultiParm& raw = slot;
+	switch (slot.get_type ())
+	{
+	case LGMultiBase::INT:
+		out << 'i' << raw.i;
+		break;
+	case LGMultiBase::FLOAT:
+		out << 'f' << raw.f;
+		break;
+	case LGMultiBase::STRING:
+		out << 's';
+		write_string (out, raw.psz);
+		break;
+	case LGMultiBase::VECTOR:
+		out << 'v' << raw.pVector->x << ' ' << raw.pVector->y << ' '
+			<< raw.pVector->z;
+		break;
+	default:
+		out << 'e';
+		break;
+	}
+}
+
+static void
+read_slot (std::istream& in, LGMultiBase& slot)
+{
+	char type = '\0';
+	in >> type;
+	switch (type)
+	{
+	case 'i':
+	{
+		int value = 0;
+		in >> value;
+		slot = (const sMultiParm&) LGMulti<int> (value);
+		break;
+	}
+	case 'f':
+	{
+		float value = 0.0f;
+		in >> value;
+		slot = (const sMultiParm&) LGMulti<float> (value);
+		break;
+	}
+	case 's':
+		slot = (const sMultiParm&) LGMulti<String> (read_string (in));
+		break;
+	case 'v':
+	{
+		Vector value;
+		in >> value.x >> value.y >> value.z;
+		slot = (const sMultiParm&) LGMulti<Vector> (value);
+		break;
+	}
+	case 'e':
+		slot.clear ();
+		break;
+	default:
+		throw std::runtime_error ("malformed data slot");
+	}
+}
+
+
+
+// TimerWheel::Entry
+
+TimerWheel::Entry::Entry ()
+	: active (false), generation (0u), prev (-1), next (-1), bucket (0u),
+	  expires (0ul), period (0ul)
+{}
+
+
+
+// TimerWheel
+
+TimerWheel::TimerWheel ()
+	: tick_serial (0), dirty_tick (false)
+{
+	reset ();
+}
+
+TimerWheel::~TimerWheel ()
+{}
+
+Timer
+TimerWheel::start (sScrMsg* message, Time delay, bool repeating,
+	const Object& host, Time now)
+{
+	if (!message || _stricmp (message->message, "Timer") != 0)
+		return Timer ();
+
+	if (!restored)
+	{
+		if (now == 0ul) return Timer ();
+		restore (now);
+	}
+
+	// Without a running driver or a host to start one on, the timer would
+	// never be delivered. (The tick is only unset while it is advancing the
+	// wheel, which arms it again.)
+	bool driven = tick_host != Object::NONE && tick_host.exists ();
+	if (!driven && (host == Object::NONE || now == 0ul))
+		return Timer ();
+
+	int slot;
+	if (!free_slots.empty ())
+	{
+		slot = free_slots.back ();
+		free_slots.pop_back ();
+	}
+	else if (int (entries.size ()) < MAX_SLOTS)
+	{
+		slot = entries.size ();
+		entries.emplace_back ();
+		set_datum (SLOTS_DATUM, LGMulti<int> (entries.size ()));
+	}
+	else
+		return Timer ();
+
+	if (active_count == 0 && now != 0ul)
+		base = now / RESOLUTION;
+	Time::Value start_time = (now != 0ul) ? Time::Value (now)
+		: base * RESOLUTION;
+	unsigned long ticks = (Time::Value (delay) + RESOLUTION - 1ul)
+		/ RESOLUTION;
+
+	Entry& entry = entries [slot];
+	entry.active = true;
+	entry.expires = (start_time + RESOLUTION - 1ul) / RESOLUTION + ticks;
+	entry.period = repeating ? std::max (ticks, 1ul) : 0ul;
+	entry.from = Object (message->from);
+	entry.to = Object (message->to);
+	entry.host = (host != Object::NONE) ? host : tick_host;
+	entry.timer = (const char*) static_cast<sScrTimerMsg*> (message)->name;
+	static_cast<LGMultiBase&> (entry.data [0]) = message->data;
+	static_cast<LGMultiBase&> (entry.data [1]) = message->data2;
+	static_cast<LGMultiBase&> (entry.data [2]) = message->data3;
+
+	++active_count;
+	link (slot);
+	persist (slot);
+
+	// Bring the tick forward if this timer is due before it.
+	if (!driven)
+		arm_tick (host, now);
+	else if (tick && long (entry.expires - tick_due) < 0)
+		arm_tick (tick_host, now);
+
+	return Timer (make_id (slot, entry.generation));
+}
+
+bool
+TimerWheel::cancel (const Timer& timer)
+{
+	uintptr_t id = reinterpret_cast<uintptr_t> (timer.id);
+	if (!(id & ID_TAG))
+		return false; // This is an engine timer.
+
+	int slot = (id >> SLOT_SHIFT) & (MAX_SLOTS - 1);
+	unsigned generation = (id >> GENERATION_SHIFT) & GENERATION_MASK;
+
+	// If the wheel hasn't been restored since the sim started, retire the
+	// stored copy of the timer instead.
+	if (!restored)
+	{
+		LGMulti<String> raw;
+		if (!get_datum (slot_datum (slot), raw))
+			return true;
+
+		std::istringstream in ((String (raw)));
+		char state = '\0';
+		unsigned stored = 0u;
+		in >> state >> stored;
+		if (state == 'M' && stored == generation)
+		{
+			uintptr_t fallback = 0u;
+			if (in >> fallback)
+				LG->KillTimedMessage (tScrTimer (fallback));
+		}
+		if ((state == 'L' || state == 'M') && stored == generation)
+			set_datum (slot_datum (slot), LGMulti<String> ("F " +
+				std::to_string ((stored + 1u) & GENERATION_MASK)));
+		return true;
+	}
+
+	if (slot < int (entries.size ()) &&
+	    entries [slot].generation == generation)
+	{
+		Entry& entry = entries [slot];
+		if (entry.active)
+		{
+			unlink (slot);
+			free_slot (slot);
+			if (active_count == 0)
+				disarm_tick ();
+		}
+		else if (entry.fallback)
+		{
+			LG->KillTimedMessage (tScrTimer (entry.fallback.id));
+			free_slot (slot);
+		}
+	}
+
+	return true;
+}
+
+void
+TimerWheel::host_added (const Object& object)
+{
+	if (object != Object::NONE)
+		++host_refs [object];
+}
+
+void
+TimerWheel::host_removed (const Object& object)
+{
+	auto ref = host_refs.find (object);
+	if (ref == host_refs.end ())
+		return;
+	if (--ref->second == 0u)
+	{
+		host_refs.erase (ref);
+		host_lost (object);
+	}
+}
+
+void
+TimerWheel::host_lost (const Object& object)
+{
+	host_refs.erase (object);
+	if (!restored) return;
+
+	// The object can no longer vouch for any of its timers.
+	for (int slot = 0; slot < int (entries.size ()); ++slot)
+		if (entries [slot].host == object)
+		{
+			entries [slot].host = Object::NONE;
+			persist (slot);
+		}
+
+	if (object == tick_host)
+	{
+		rehost ();
+		flush ();
+	}
+}
+
+void
+TimerWheel::advance (Time now, int serial)
+{
+	if (!restored)
+		restore (now);
+
+	// Every ThiefLib script on the host receives the tick, but only the
+	// first copy is acted upon. The one-shot engine timer is spent now.
+	if (!tick || serial != tick_serial)
+		return;
+	tick = Timer ();
+
+	unsigned long target = now / RESOLUTION;
+	std::vector<int> due;
+
+	while (active_count != 0 && long (target - base) >= 0)
+	{
+		size_t index = base & ROOT_MASK;
+
+		// When the root level wraps, redistribute the next bucket of each
+		// outer level whose own index has also wrapped.
+		if (index == 0)
+			for (unsigned level = 1; level < LEVELS; ++level)
+				if (cascade (level) != 0)
+					break;
+
+		++base;
+
+		// Timers are delivered synchronously, so their handlers may start
+		// and cancel others. The bucket is detached before any fire.
+		due.clear ();
+		int slot = buckets [index];
+		buckets [index] = -1;
+		while (slot >= 0)
+		{
+			Entry& entry = entries [slot];
+			due.push_back (slot);
+			slot = entry.next;
+			entry.prev = entry.next = -1;
+			entry.bucket = DETACHED;
+		}
+
+		for (int _slot : due)
+			if (entries [_slot].active &&
+			    entries [_slot].bucket == DETACHED)
+				fire (_slot);
+	}
+
+	if (active_count == 0)
+	{
+		if (long (target - base) >= 0)
+			base = target + 1ul;
+		disarm_tick ();
+	}
+	else if (!tick)
+	{
+		if (tick_host != Object::NONE && tick_host.exists ())
+			arm_tick (tick_host, now);
+		else
+			rehost ();
+	}
+
+	flush ();
+}
+
+void
+TimerWheel::flush ()
+{
+	for (int slot : dirty_slots)
+		if (slot < int (entries.size ()))
+		{
+			const Entry& entry = entries [slot];
+
+			std::ostringstream out;
+			out << std::setprecision (9);
+			if (entry.active)
+			{
+				out << "L " << entry.generation << ' '
+					<< entry.expires << ' ' << entry.period
+					<< ' ' << entry.from.number << ' '
+					<< entry.to.number << ' '
+					<< entry.host.number << ' ';
+				write_string (out, entry.timer);
+				for (auto& data : entry.data)
+				{
+					out << ' ';
+					write_slot (out, data);
+				}
+			}
+			else if (entry.fallback)
+				out << "M " << entry.generation << ' '
+					<< reinterpret_cast<uintptr_t>
+						(entry.fallback.id);
+			else
+				out << "F " << entry.generation;
+
+			set_datum (slot_datum (slot),
+				LGMulti<String> (out.str ()));
+		}
+	dirty_slots.clear ();
+
+	if (dirty_tick)
+	{
+		if (tick)
+		{
+			std::ostringstream out;
+			out << reinterpret_cast<uintptr_t> (tick.id) << ' '
+				<< tick_host.number << ' ' << tick_serial << ' '
+				<< tick_due;
+			set_datum (TICK_DATUM, LGMulti<String> (out.str ()));
+		}
+		else
+			clear_datum (TICK_DATUM);
+		dirty_tick = false;
+	}
+}
+
+void
+TimerWheel::reset ()
+{
+	// Engine timers, including the tick, don't survive the sim; the stored
+	// copies are left alone for any saved game.
+	entries.clear ();
+	free_slots.clear ();
+	buckets.fill (-1);
+	active_count = 0;
+	base = 0ul;
+	restored = false;
+	tick = Timer ();
+	tick_host = Object::NONE;
+	tick_due = 0ul;
+	dirty_slots.clear ();
+	dirty_tick = false;
+}
+
+void*
+TimerWheel::make_id (int slot, unsigned generation)
+{
+	return reinterpret_cast<void*> (ID_TAG |
+		(uintptr_t (generation & GENERATION_MASK) << GENERATION_SHIFT) |
+		(uintptr_t (slot) << SLOT_SHIFT));
+}
+
+void
+TimerWheel::link (int slot)
+{
+	Entry& entry = entries [slot];
+
+	long offset = long (entry.expires - base);
+	if (offset >= long (MAX_TICKS))
+	{
+		entry.expires = base + MAX_TICKS - 1ul;
+		offset = MAX_TICKS - 1ul;
+	}
+
+	if (offset < 0) // overdue; deliver with the next tick
+		entry.bucket = base & ROOT_MASK;
+	else if (offset < ROOT_SIZE)
+		entry.bucket = entry.expires & ROOT_MASK;
+	else
+	{
+		unsigned level = 1;
+		while (offset >= (1l << (ROOT_BITS + level * LEVEL_BITS)))
+			++level;
+		entry.bucket = ROOT_SIZE + (level - 1) * LEVEL_SIZE +
+			((entry.expires >> (ROOT_BITS + (level - 1) * LEVEL_BITS))
+				& LEVEL_MASK);
+	}
+
+	entry.prev = -1;
+	entry.next = buckets [entry.bucket];
+	if (entry.next >= 0)
+		entries [entry.next].prev = slot;
+	buckets [entry.bucket] = slot;
+}
+
+void
+TimerWheel::unlink (int slot)
+{
+	Entry& entry = entries [slot];
+	if (entry.bucket == DETACHED)
+		return; // already out of its bucket to be fired
+	if (entry.prev >= 0)
+		entries [entry.prev].next = entry.next;
+	else
+		buckets [entry.bucket] = entry.next;
+	if (entry.next >= 0)
+		entries [entry.next].prev = entry.prev;
+	entry.prev = entry.next = -1;
+}
+
+size_t
+TimerWheel::cascade (unsigned level)
+{
+	size_t index = (base >> (ROOT_BITS + (level - 1) * LEVEL_BITS))
+		& LEVEL_MASK;
+	int& head = buckets [ROOT_SIZE + (level - 1) * LEVEL_SIZE + index];
+
+	int slot = head;
+	head = -1;
+	while (slot >= 0)
+	{
+		int next = entries [slot].next;
+		link (slot);
+		slot = next;
+	}
+
+	return index;
+}
+
+void
+TimerWheel::fire (int slot)
+{
+	Entry& entry = entries [slot];
+	unsigned generation = entry.generation;
+
+	// A repeating timer is rescheduled first, so that its handler may
+	// cancel it. (Entries stay put as the deque grows.) It remains stored
+	// with its first expiry, which restore() brings forward.
+	if (entry.period != 0ul)
+	{
+		entry.expires += entry.period;
+		link (slot);
+	}
+
+	try
+	{
+		TimerMessage message (entry.timer);
+		for (size_t index = 0; index < 3; ++index)
+			if (!entry.data [index].empty ())
+				message.set_data (Message::Slot (index),
+					(const sMultiParm&) entry.data [index]);
+		message.send (entry.from, entry.to);
+	}
+	catch (std::exception& e)
+	{
+		mono.log (boost::format ("WARNING: Could not deliver timer "
+			"\"%||\" to %||: %||.") % entry.timer % entry.to
+			% e.what ());
+	}
+	catch (...) {}
+
+	// The handler may have cancelled the timer already.
+	if (entry.period == 0ul && entry.active &&
+	    entry.generation == generation && entry.bucket == DETACHED)
+		free_slot (slot);
+}
+
+void
+TimerWheel::free_slot (int slot)
+{
+	Entry& entry = entries [slot];
+	if (entry.active)
+		--active_count;
+	entry.active = false;
+	entry.generation = (entry.generation + 1u) & GENERATION_MASK;
+	entry.host = Object::NONE;
+	entry.timer.clear ();
+	for (auto& data : entry.data)
+		data.clear ();
+	entry.fallback = Timer ();
+
+	free_slots.push_back (slot);
+	persist (slot);
+}
+
+void
+TimerWheel::migrate (int slot)
+{
+	Entry& entry = entries [slot];
+	unlink (slot);
+	entry.active = false;
+	--active_count;
+
+	// The wheel is no longer driven, so scheduling the message yields an
+	// engine timer. A repeating timer keeps its period but may fire its
+	// next occurrence up to one period off.
+	unsigned long ticks = (entry.period != 0ul) ? entry.period
+		: std::max (long (entry.expires - base) + 1l, 1l);
+	Time delay = ticks * RESOLUTION;
+	try
+	{
+		TimerMessage message (entry.timer);
+		for (size_t index = 0; index < 3; ++index)
+			if (!entry.data [index].empty ())
+				message.set_data (Message::Slot (index),
+					(const sMultiParm&) entry.data [index]);
+		entry.fallback = message.schedule (entry.from, entry.to, delay,
+			entry.period != 0ul);
+	}
+	catch (std::exception& e)
+	{
+		mono.log (boost::format ("WARNING: Could not reschedule timer "
+			"\"%||\" to %||: %||.") % entry.timer % entry.to
+			% e.what ());
+	}
+	catch (...) {}
+
+	if (!entry.fallback)
+	{
+		free_slot (slot);
+		return;
+	}
+
+	// Keep the slot so that the timer can still be cancelled by its ID.
+	entry.host = Object::NONE;
+	entry.timer.clear ();
+	for (auto& data : entry.data)
+		data.clear ();
+	persist (slot);
+}
+
+unsigned long
+TimerWheel::next_due () const
+{
+	// Outer levels only cascade as the root level wraps, so nothing can be
+	// due between the last occupied root bucket and the next wrap.
+	unsigned long wrap = (base + ROOT_MASK) & ~(unsigned long) ROOT_MASK;
+	for (unsigned long due = base; due != wrap; ++due)
+		if (buckets [due & ROOT_MASK] >= 0)
+			return due;
+	return wrap;
+}
+
+void
+TimerWheel::arm_tick (const Object& host, Time now)
+{
+	if (tick)
+		LG->KillTimedMessage (tScrTimer (tick.id));
+
+	// Without the current time, wake soon to learn it and arm again then.
+	tick_due = next_due ();
+	Time::Value due_time = tick_due * RESOLUTION;
+	Time delay = (now == 0ul) ? RESOLUTION
+		: (due_time > Time::Value (now)) ? due_time - Time::Value (now)
+		: 1ul;
+
+	++tick_serial;
+	tick = Timer (LG->SetTimedMessage2 (host.number, TIMER_WHEEL_TICK,
+		delay, kSTM_OneShot, LGMulti<int> (tick_serial)));
+	tick_host = host;
+	persist_tick ();
+}
+
+void
+TimerWheel::disarm_tick ()
+{
+	if (tick)
+		LG->KillTimedMessage (tScrTimer (tick.id));
+	if (!tick && tick_host == Object::NONE) return;
+	tick = Timer ();
+	tick_host = Object::NONE;
+	persist_tick ();
+}
+
+void
+TimerWheel::restore (Time now)
+{
+	restored = true;
+	base = now / RESOLUTION;
+
+	LGMulti<int> slots;
+	if (get_datum (SLOTS_DATUM, slots))
+		for (int slot = 0; slot < int (slots) && slot < MAX_SLOTS; ++slot)
+		{
+			entries.emplace_back ();
+			Entry& entry = entries.back ();
+
+			try
+			{
+				LGMulti<String> raw;
+				if (!get_datum (slot_datum (slot), raw))
+					throw std::runtime_error ("missing data");
+
+				std::istringstream in ((String (raw)));
+				char state = '\0';
+				in >> state >> entry.generation;
+				entry.generation &= GENERATION_MASK;
+
+				if (state == 'L')
+				{
+					in >> entry.expires >> entry.period
+						>> entry.from.number
+						>> entry.to.number
+						>> entry.host.number;
+					entry.timer = read_string (in);
+					for (auto& data : entry.data)
+						read_slot (in, data);
+					if (!in)
+						throw std::runtime_error
+							("malformed data");
+					entry.active = true;
+				}
+				else if (state == 'M')
+				{
+					uintptr_t fallback = 0u;
+					in >> fallback;
+					if (!in)
+						throw std::runtime_error
+							("malformed data");
+					entry.fallback = Timer
+						(reinterpret_cast<void*> (fallback));
+				}
+			}
+			catch (std::exception& e)
+			{
+				mono.log (boost::format ("WARNING: Could not "
+					"restore timer %||: %||.") % slot
+					% e.what ());
+				entry.active = false;
+				entry.timer.clear ();
+				for (auto& data : entry.data)
+					data.clear ();
+				entry.fallback = Timer ();
+			}
+
+			if (entry.fallback)
+				continue;
+			if (!entry.active)
+			{
+				free_slots.push_back (slot);
+				continue;
+			}
+
+			// Repeating timers are stored with their first expiry.
+			if (entry.period != 0ul && long (entry.expires - base) < 0)
+				entry.expires += ((base - entry.expires +
+					entry.period - 1ul) / entry.period)
+					* entry.period;
+
+			++active_count;
+			link (slot);
+		}
+
+	LGMulti<String> _tick;
+	if (get_datum (TICK_DATUM, _tick))
+	{
+		std::istringstream in ((String (_tick)));
+		uintptr_t id = 0u;
+		in >> id >> tick_host.number >> tick_serial >> tick_due;
+		if (in)
+			tick = Timer (reinterpret_cast<void*> (id));
+		else
+			tick_host = Object::NONE;
+	}
+
+	if (active_count == 0)
+		disarm_tick ();
+	else if (!tick || !tick_host.exists ())
+		rehost ();
+}
+
+void
+TimerWheel::rehost ()
+{
+	for (auto& entry : entries)
+		if (entry.active && entry.host != Object::NONE &&
+		    entry.host.exists ())
+		{
+			arm_tick (entry.host, 0ul);
+			return;
+		}
+
+	// No other host is known, so nothing would ever drive the wheel.
+	disarm_tick ();
+	for (int slot = 0; slot < int (entries.size ()); ++slot)
+		if (entries [slot].active)
+			migrate (slot);
+}
+
+void
+TimerWheel::persist (int slot)
+{
+	// Written out by flush() once per tick or dispatch, not on every change.
+	dirty_slots.insert (slot);
+}
+
+void
+TimerWheel::persist_tick ()
+{
+	dirty_tick = true;
+}
+
+
+
+} // namespace Thief
+
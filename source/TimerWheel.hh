@@ -0,0 +1,157 @@
+/******************************************************************************
+ *  TimerWheel.hh
+ *
+ *  This file is part of ThiefLib, a library for Thief 1/2 script modules.
+ *  Copyright (C) 2013 Kevin Daughtridge <kevin@kdau.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *****************************************************************************/
+
+#ifndef TIMERWHEEL_HH
+#define TIMERWHEEL_HH
+
+#include "Private.hh"
+#include <deque>
+#include <set>
+
+// The timer name of the engine timer that drives the wheel. Its data is the
+// serial number of the tick, for telling a fresh tick from a stale copy.
+#define TIMER_WHEEL_TICK "ThiefLibTimerWheel"
+
+#ifdef IS_OSL
+
+namespace Thief {
+
+
+
+// TimerWheel: multiplexes Timer messages onto a single engine timer
+
+class TimerWheel
+{
+public:
+	TimerWheel ();
+	~TimerWheel ();
+
+	// Returns a null Timer if the message cannot be multiplexed, in which
+	// case the caller should fall back to an engine timer. The host must
+	// be an object with a ThiefLib script, or Object::NONE if the caller
+	// cannot vouch for one; now is zero if the sim time is unknown.
+	Timer start (sScrMsg* message, Time delay, bool repeating,
+		const Object& host, Time now);
+
+	// Returns whether the timer belongs to the wheel (live or not).
+	bool cancel (const Timer&);
+
+	// Called as each ThiefLib script on an object is created and destroyed.
+	// An object remains a candidate host until its last such script is gone.
+	void host_added (const Object&);
+	void host_removed (const Object&);
+
+	// Called when an object is destroyed or loses its last ThiefLib script.
+	// If it was driving the wheel, the tick moves to another host that
+	// vouched for a pending timer, or failing that, each pending timer is
+	// handed over to an engine timer of its own.
+	void host_lost (const Object&);
+
+	// Called with the data of each TIMER_WHEEL_TICK message received.
+	void advance (Time now, int serial);
+
+	// Writes changed timers to the saved-game store. This is done after each
+	// tick and at the end of each outermost dispatch, so that a game saved
+	// between messages holds every timer.
+	void flush ();
+
+	void reset ();
+
+private:
+	enum
+	{
+		ROOT_BITS = 8,
+		ROOT_SIZE = 1 << ROOT_BITS,
+		ROOT_MASK = ROOT_SIZE - 1,
+		LEVEL_BITS = 6,
+		LEVEL_SIZE = 1 << LEVEL_BITS,
+		LEVEL_MASK = LEVEL_SIZE - 1,
+		LEVELS = 4,
+		BUCKETS = ROOT_SIZE + (LEVELS - 1) * LEVEL_SIZE,
+		DETACHED = BUCKETS // the bucket of an entry about to fire
+	};
+
+	struct Entry
+	{
+		Entry ();
+
+		bool active;
+		unsigned generation;
+		int prev, next;
+		size_t bucket;
+
+		unsigned long expires, period; // in ticks
+		Object from, to, host;
+		String timer;
+		LGMulti<sMultiParm> data [3];
+
+		// The engine timer that took over if no host remained.
+		Timer fallback;
+	};
+
+	typedef std::deque<Entry> Entries;
+	Entries entries;
+	std::vector<int> free_slots;
+	std::array<int, BUCKETS> buckets;
+	size_t active_count;
+	unsigned long base; // the next tick to be processed
+
+	bool restored;
+
+	// The one-shot engine timer for the next tick with anything to do.
+	Timer tick;
+	Object tick_host;
+	int tick_serial;
+	unsigned long tick_due;
+
+	typedef std::map<Object, unsigned> HostRefs;
+	HostRefs host_refs; // not reset with the sim, like the scripts
+
+	std::set<int> dirty_slots;
+	bool dirty_tick;
+
+	static void* make_id (int slot, unsigned generation);
+
+	void link (int slot);
+	void unlink (int slot);
+	size_t cascade (unsigned level);
+	void fire (int slot);
+	void free_slot (int slot);
+	void migrate (int slot);
+
+	unsigned long next_due () const;
+	void arm_tick (const Object& host, Time now);
+	void disarm_tick ();
+	void rehost ();
+
+	void restore (Time now);
+	void persist (int slot);
+	void persist_tick ();
+};
+
+
+
+} // namespace Thief
+
+#endif // IS_OSL
+
+#endif // TIMERWHEEL_HH
+
@@ -86,7 +86,8 @@ MESSAGE_WRAPPER_IMPL (TweqMessage, "TweqComplete"),
 
 TweqMessage::TweqMessage (Event _event, Tweq::Type _tweq_type,
 		Tweq::Direction _direction)
-	: Message (new sTweqMsg ()), event (_event), tweq_type (_tweq_type),
+	: Message (new PooledMessage<sTweqMsg> ()),
+	  event (_event), tweq_type (_tweq_type),
 	  direction (_direction)
 {
 	message->message = "TweqComplete";
@@ -38,7 +38,7 @@ OBJECT_TYPE_IMPL_ (Combinable,
 int
 Combinable::adjust_stack_count (int by, bool destroy_if_zero)
 {
-	return SInterface<IContainSys> (LG)->StackAdd
+	return cached_interface<IContainSys> ()->StackAdd
 		(number, by, destroy_if_zero);
 }
 
@@ -58,7 +58,7 @@ MESSAGE_WRAPPER_IMPL (CombineMessage, "Combine"),
 {}
 
 CombineMessage::CombineMessage (const Object& _stack)
-	: Message (new sCombineScrMsg ()),
+	: Message (new PooledMessage<sCombineScrMsg> ()),
 	  stack (_stack)
 {
 	message->message = "Combine";
@@ -85,20 +85,20 @@ OBJECT_TYPE_IMPL_ (Damageable, SoundSource (), Reagent (),
 void
 Damageable::damage (const Object& stimulus, int intensity, const Object& culprit)
 {
-	SService<IDamageSrv> (LG)->Damage
+	cached_service<IDamageSrv> ()->Damage
 		(number, culprit.number, intensity, stimulus.number);
 }
 
 void
 Damageable::slay (const Object& culprit)
 {
-	SService<IDamageSrv> (LG)->Slay (number, culprit.number);
+	cached_service<IDamageSrv> ()->Slay (number, culprit.number);
 }
 
 void
 Damageable::resurrect (const Object& culprit)
 {
-	SService<IDamageSrv> (LG)->Resurrect (number, culprit.number);
+	cached_service<IDamageSrv> ()->Resurrect (number, culprit.number);
 }
 
 
@@ -113,7 +113,7 @@ MESSAGE_WRAPPER_IMPL (DamageMessage, "Damage"),
 
 DamageMessage::DamageMessage (const Object& _culprit, const Object& _stimulus,
 		int _hit_points)
-	: Message (new sDamageScrMsg ()),
+	: Message (new PooledMessage<sDamageScrMsg> ()),
 	  culprit (_culprit),
 	  stimulus (_stimulus),
 	  hit_points (_hit_points)
@@ -134,7 +134,7 @@ MESSAGE_WRAPPER_IMPL (SlayMessage, "Slain"),
 {}
 
 SlayMessage::SlayMessage (const Object& _culprit, const Object& _stimulus)
-	: Message (new sSlayMsg ()),
+	: Message (new PooledMessage<sSlayMsg> ()),
 	  culprit (_culprit),
 	  stimulus (_stimulus)
 {
@@ -275,7 +275,8 @@ MESSAGE_WRAPPER_IMPL_ (FrobMessage,
 FrobMessage::FrobMessage (Event _event, const Object& _frobber,
 		const Object& _tool, const Object& _frobbed, Location _frob_loc,
 		Location _obj_loc, Time _duration, bool _was_aborted)
-	: Message (new sFrobMsg ()), event (_event), frobber (_frobber),
+	: Message (new PooledMessage<sFrobMsg> ()),
+	  event (_event), frobber (_frobber),
 	  tool (_tool), frobbed (_frobbed), frob_loc (_frob_loc),
 	  obj_loc (_obj_loc), duration (_duration), was_aborted (_was_aborted)
 {
@@ -337,7 +338,7 @@ bool
 Container::contains (const Object& maybe_contained, bool inherit)
 {
 	return inherit
-		? SInterface<IContainSys> (LG)->Contains
+		? cached_interface<IContainSys> ()->Contains
 			(number, maybe_contained.number)
 		: get_contain_type (maybe_contained) != Type::NONE;
 }
@@ -345,7 +346,7 @@ Container::contains (const Object& maybe_contained, bool inherit)
 Container::Type
 Container::get_contain_type (const Object& maybe_contained)
 {
-	return Type (SInterface<IContainSys> (LG)->IsHeld
+	return Type (cached_interface<IContainSys> ()->IsHeld
 		(number, maybe_contained.number));
 }
 
@@ -353,32 +354,33 @@ Container::Contents
 Container::get_contents () const
 {
 	Contents contents;
-	sContainIter* iter = SInterface<IContainSys> (LG)->IterStart (number);
+	IContainSys* CS = cached_interface<IContainSys> ();
+	sContainIter* iter = CS->IterStart (number);
 	do
 		contents.emplace_back (Object (iter->Object),
 			Type (iter->ContainType), Link (iter->Link));
-	while (SInterface<IContainSys> (LG)->IterNext (iter));
-	SInterface<IContainSys> (LG)->IterEnd (iter);
+	while (CS->IterNext (iter));
+	CS->IterEnd (iter);
 	return contents;
 }
 
 bool
 Container::add_contents (const Object& contained, Type type, bool combine)
 {
-	return SService<IContainSrv> (LG)->Add
+	return cached_service<IContainSrv> ()->Add
 		(contained.number, number, int (type), combine) == S_OK;
 }
 
 void
 Container::remove_contents (const Object& contained)
 {
-	SService<IContainSrv> (LG)->Remove (contained.number, number);
+	cached_service<IContainSrv> ()->Remove (contained.number, number);
 }
 
 void
 Container::move_contents (const Object& new_container, bool combine)
 {
-	SService<IContainSrv> (LG)->MoveAllContents
+	cached_service<IContainSrv> ()->MoveAllContents
 		(number, new_container.number, combine);
 }
 
@@ -421,8 +423,8 @@ MESSAGE_WRAPPER_IMPL_ (ContainmentMessage,
 ContainmentMessage::ContainmentMessage (Subject _subject, Event _event,
 		const Object& _container, const Object& _content)
 	: Message ((_subject == CONTAINER)
-		? static_cast<sScrMsg*> (new sContainerScrMsg ())
-		: static_cast<sScrMsg*> (new sContainedScrMsg ())),
+		? static_cast<sScrMsg*> (new PooledMessage<sContainerScrMsg> ())
+		: static_cast<sScrMsg*> (new PooledMessage<sContainedScrMsg> ())),
 	  subject (_subject), event (_event),
 	  container (_container), content (_content)
 {
@@ -582,7 +584,8 @@ MESSAGE_WRAPPER_IMPL_ (RoomMessage,
 RoomMessage::RoomMessage (Event _event, ObjectType _object_type,
 		const Object& _object, const Object& _from_room,
 		const Object& _to_room)
-	: Message (new sRoomMsg ()), event (_event), object_type (_object_type),
+	: Message (new PooledMessage<sRoomMsg> ()),
+	  event (_event), object_type (_object_type),
 	  object (_object), from_room (_from_room), to_room (_to_room)
 {
 	switch (event)
@@ -633,7 +636,7 @@ OBJECT_TYPE_IMPL_ (Secret,
 void
 Secret::find_secret ()
 {
-	SService<IDarkGameSrv> (LG)->FoundObject (number);
+	cached_service<IDarkGameSrv> ()->FoundObject (number);
 }
 
 #endif // IS_THIEF2